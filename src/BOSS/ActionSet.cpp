@@ -20,36 +20,55 @@ bool ActionSet::isEmpty() const
 
 bool ActionSet::contains(const ActionType action) const
 {
-    return std::find(m_actions.begin(), m_actions.end(), action) != m_actions.end();
+    return m_contains.test(action.getID());
 }
 
 void ActionSet::add(const ActionType action)
 {
     if (!contains(action))
     {
+        m_contains.set(action.getID());
         m_actions.push_back(action);
     }
 }
 
 void ActionSet::add(const ActionSet & set)
 {
+    const ActionBits added = set.m_contains & ~m_contains;
+    if (added.none())
+    {
+        return;
+    }
+
+    // append the new actions in the order the other set has them
+    m_contains |= added;
     for (const auto & val : set.m_actions)
     {
-        add(val);
+        if (added.test(val.getID()))
+        {
+            m_actions.push_back(val);
+        }
     }
 }
 
 void ActionSet::remove(const ActionType action)
 {
-    m_actions.erase(std::remove(m_actions.begin(), m_actions.end(), action), m_actions.end());
+    if (contains(action))
+    {
+        m_contains.reset(action.getID());
+        m_actions.erase(std::find(m_actions.begin(), m_actions.end(), action));
+    }
 }
 
 void ActionSet::remove(const ActionSet & set)
 {
-    for (const auto & val : set.m_actions)
+    if ((m_contains & set.m_contains).none())
     {
-        remove(val);
+        return;
     }
+
+    m_contains &= ~set.m_contains;
+    m_actions.erase(std::remove_if(m_actions.begin(), m_actions.end(), [this](const ActionType & val) { return !m_contains.test(val.getID()); }), m_actions.end());
 }
 
 const std::string ActionSet::toString() const
@@ -66,12 +85,13 @@ const std::string ActionSet::toString() const
 
 void ActionSet::clear()
 {
+    m_contains.reset();
     m_actions.clear();
 }
 
-ActionType & ActionSet::operator[] (const size_t index)
+const ActionBits & ActionSet::getBits() const
 {
-    return m_actions[index];
+    return m_contains;
 }
 
 ActionType ActionSet::operator[] (const size_t index) const
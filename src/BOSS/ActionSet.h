@@ -1,15 +1,28 @@
 #pragma once
 
 #include "Common.h"
+#include <bitset>
 #include <vector>
 
+// the highest number of action types the data files can define, the width of the ActionSet bitset
+#ifndef BOSS_MAX_ACTION_TYPES
+#define BOSS_MAX_ACTION_TYPES 256
+#endif
+
 namespace BOSS
 {
 
 class ActionType;
+
+// one bit per ActionID
+typedef std::bitset<BOSS_MAX_ACTION_TYPES> ActionBits;
+
+// a set of action types which remembers the order they were added in, since the searches
+// try legal actions in that order, while membership and set algebra go through a bitset
 class ActionSet
 {
-	std::vector<ActionType> m_actions;
+    ActionBits              m_contains;     // bit i is set if the action with ActionID i is in the set
+    std::vector<ActionType> m_actions;      // the same actions, in the order they were added
 
 public:
 
@@ -25,10 +38,10 @@ public:
     void remove(const ActionSet & set);
     void clear();
 
-    ActionType & operator[] (const size_t index);
     ActionType operator[] (const size_t index) const;
+    const ActionBits & getBits() const;
 
     const std::string toString() const;
 };
 
-}
\ No newline at end of file
+}
@@ -6,6 +6,47 @@ using namespace BOSS;
 
 std::vector<ActionSet> allActionPrerequisites;
 std::vector<ActionSet> allActionRecursivePrerequisites;
+std::vector<ActionBits> allActionEquivalentMasks;           // each type and the types equivalent to it
+std::vector<std::vector<ActionBits>> allActionRequiredMasks;    // the equivalent mask of each type in required()
+
+// the ActionTypeData fields the searches read all the time, packed into one small record per action
+// so that they share a cache line, the names and other strings stay in ActionTypeData
+struct ActionTypeHotData
+{
+    enum Flags : uint16_t
+    {
+        IsUnit              = 1 << 0,
+        IsUpgrade           = 1 << 1,   // also set for tech
+        IsAbility           = 1 << 2,
+        IsBuilding          = 1 << 3,
+        IsWorker            = 1 << 4,
+        IsRefinery          = 1 << 5,
+        IsSupplyProvider    = 1 << 6,
+        IsDepot             = 1 << 7,
+        IsAddon             = 1 << 8,
+        IsHatchery          = 1 << 9,
+        IsMorphed           = 1 << 10,
+        IsTech              = 1 << 11
+    };
+
+    int32_t     buildTime       = 0;
+    int16_t     mineralCost     = 0;
+    int16_t     gasCost         = 0;
+    int16_t     supplyCost      = 0;
+    int16_t     supplyProvided  = 0;
+    int16_t     buildLimit      = 0;
+    uint16_t    whatBuilds      = 0;
+    uint16_t    whatBuildsAddon = 0;
+    uint16_t    flags           = 0;
+    uint8_t     whatBuildsCount = 1;
+    uint8_t     race            = Races::None;
+
+    bool has(const Flags flag) const { return (flags & flag) != 0; }
+};
+
+static_assert(sizeof(ActionTypeHotData) <= 32, "ActionTypeHotData should stay small enough to share a cache line");
+
+std::vector<ActionTypeHotData> allActionHotData;
 
 ActionType::ActionType()
 {
@@ -13,7 +54,7 @@ ActionType::ActionType()
 }
 
 ActionType::ActionType(const ActionID actionID)
-    : m_id(actionID)
+    : m_id(static_cast<uint16_t>(actionID))
 {
 
 }
@@ -23,53 +64,43 @@ ActionType::ActionType(const std::string& str)
     *this = ActionTypes::GetActionType(str);
 }
 
-ActionType & ActionType::operator = (const ActionType & rhs)
-{
-    if (this != &rhs)
-    {
-        new (this) ActionType(rhs);
-    }
-
-    return *this;
-}   
-
 ActionID    ActionType::getID()      const { return m_id; }
-RaceID      ActionType::getRace()    const { return ActionTypeData::GetActionTypeData(m_id).race; }
+RaceID      ActionType::getRace()    const { return allActionHotData[m_id].race; }
 const std::string & ActionType::getName()   const { return ActionTypeData::GetActionTypeData(m_id).name; }
 	
-int  ActionType::buildTime()         const { return ActionTypeData::GetActionTypeData(m_id).buildTime; }
-int  ActionType::mineralPrice()      const { return ActionTypeData::GetActionTypeData(m_id).mineralCost; }
-int  ActionType::gasPrice()          const { return ActionTypeData::GetActionTypeData(m_id).gasCost; }
-int  ActionType::supplyCost()        const { return ActionTypeData::GetActionTypeData(m_id).supplyCost; }
-int  ActionType::supplyProvided()    const { return ActionTypeData::GetActionTypeData(m_id).supplyProvided; }
+int  ActionType::buildTime()         const { return allActionHotData[m_id].buildTime; }
+int  ActionType::mineralPrice()      const { return allActionHotData[m_id].mineralCost; }
+int  ActionType::gasPrice()          const { return allActionHotData[m_id].gasCost; }
+int  ActionType::supplyCost()        const { return allActionHotData[m_id].supplyCost; }
+int  ActionType::supplyProvided()    const { return allActionHotData[m_id].supplyProvided; }
 int  ActionType::numProduced()       const { return 1; }
-int  ActionType::buildLimit()        const { return ActionTypeData::GetActionTypeData(m_id).buildLimit; }
-bool ActionType::isAddon()           const { return ActionTypeData::GetActionTypeData(m_id).isAddon; }
-bool ActionType::isRefinery()        const { return ActionTypeData::GetActionTypeData(m_id).isRefinery; }
-bool ActionType::isWorker()          const { return ActionTypeData::GetActionTypeData(m_id).isWorker; }
-bool ActionType::isBuilding()        const { return ActionTypeData::GetActionTypeData(m_id).isBuilding; }
-bool ActionType::isDepot()           const { return ActionTypeData::GetActionTypeData(m_id).isDepot; }
-bool ActionType::isSupplyProvider()  const { return ActionTypeData::GetActionTypeData(m_id).isSupplyProvider; }
-bool ActionType::isUnit()            const { return ActionTypeData::GetActionTypeData(m_id).isUnit; }
-bool ActionType::isUpgrade()         const { return isTech() || ActionTypeData::GetActionTypeData(m_id).isUpgrade; }
-bool ActionType::isAbility()         const { return ActionTypeData::GetActionTypeData(m_id).isAbility; }
-bool ActionType::isMorphed()         const { return ActionTypeData::GetActionTypeData(m_id).isMorphed; }
-bool ActionType::isHatchery()        const { return ActionTypeData::GetActionTypeData(m_id).isHatchery; }
-bool ActionType::isTech()            const { return ActionTypeData::GetActionTypeData(m_id).isTech; }
+int  ActionType::buildLimit()        const { return allActionHotData[m_id].buildLimit; }
+bool ActionType::isAddon()           const { return allActionHotData[m_id].has(ActionTypeHotData::IsAddon); }
+bool ActionType::isRefinery()        const { return allActionHotData[m_id].has(ActionTypeHotData::IsRefinery); }
+bool ActionType::isWorker()          const { return allActionHotData[m_id].has(ActionTypeHotData::IsWorker); }
+bool ActionType::isBuilding()        const { return allActionHotData[m_id].has(ActionTypeHotData::IsBuilding); }
+bool ActionType::isDepot()           const { return allActionHotData[m_id].has(ActionTypeHotData::IsDepot); }
+bool ActionType::isSupplyProvider()  const { return allActionHotData[m_id].has(ActionTypeHotData::IsSupplyProvider); }
+bool ActionType::isUnit()            const { return allActionHotData[m_id].has(ActionTypeHotData::IsUnit); }
+bool ActionType::isUpgrade()         const { return allActionHotData[m_id].has(ActionTypeHotData::IsUpgrade); }
+bool ActionType::isAbility()         const { return allActionHotData[m_id].has(ActionTypeHotData::IsAbility); }
+bool ActionType::isMorphed()         const { return allActionHotData[m_id].has(ActionTypeHotData::IsMorphed); }
+bool ActionType::isHatchery()        const { return allActionHotData[m_id].has(ActionTypeHotData::IsHatchery); }
+bool ActionType::isTech()            const { return allActionHotData[m_id].has(ActionTypeHotData::IsTech); }
 
 ActionType ActionType::whatBuilds() const
 {
-    return ActionTypeData::GetActionTypeData(m_id).whatBuilds;
+    return allActionHotData[m_id].whatBuilds;
 }
 
 ActionType ActionType::whatBuildsAddon() const
 {
-    return ActionTypeData::GetActionTypeData(m_id).whatBuildsAddon;
+    return allActionHotData[m_id].whatBuildsAddon;
 }
 
 int ActionType::whatBuildsCount() const
 {
-    return static_cast<int>(ActionTypeData::GetActionTypeData(m_id).whatBuildsCount);
+    return allActionHotData[m_id].whatBuildsCount;
 }
 
 const std::vector<ActionType> & ActionType::required() const
@@ -83,6 +114,18 @@ const std::vector<ActionType> & ActionType::equivalent() const
 }
 
 
+// a type is equivalent to this one if it is this type or one of this type's equivalents
+const ActionBits & ActionType::equivalentMask() const
+{
+    return allActionEquivalentMasks[m_id];
+}
+
+// each of these needs at least one of the types in it for this type's prerequisites to be met
+const std::vector<ActionBits> & ActionType::requiredMasks() const
+{
+    return allActionRequiredMasks[m_id];
+}
+
 const ActionSet & ActionType::getPrerequisiteActionCount() const
 {
     return allActionPrerequisites[m_id];
@@ -99,13 +142,7 @@ bool ActionType::operator <  (const ActionType rhs)     const { return m_id < rh
 
 bool ActionType::isEquivalentTo(const ActionType other)   const 
 {
-    if (*this != other)
-    {
-        auto& equivalents = other.equivalent();
-        auto it = std::find(equivalents.begin(), equivalents.end(), *this);
-        if (it == equivalents.end()) { return false; }
-    }
-    return true;
+    return other.equivalentMask().test(m_id);
 };
 
 namespace BOSS
@@ -118,29 +155,137 @@ namespace ActionTypes
     std::vector<ActionType>  refineryActionTypes;
     std::vector<ActionType>  supplyProviderActionTypes;
     std::vector<ActionType>  resourceDepotActionTypes;
+    std::vector<ActionType>  larvaActionTypes;
+    std::vector<ActionType>  hatcheryActionTypes;
+
+    // finds the type playing each special role for each race from the data file's flags rather than by name,
+    // a role a race doesn't have, like larva for Protoss, is ActionTypes::None
+    void InitRoles()
+    {
+        for (auto * roles : { &workerActionTypes, &refineryActionTypes, &supplyProviderActionTypes, &resourceDepotActionTypes, &larvaActionTypes, &hatcheryActionTypes })
+        {
+            roles->assign(Races::NUM_RACES, ActionTypes::None);
+        }
+
+        for (const ActionType & type : allActionTypes)
+        {
+            const RaceID race = type.getRace();
+            if (race >= Races::NUM_RACES) { continue; }
+
+            if (type.isWorker()         && workerActionTypes[race] == ActionTypes::None)           { workerActionTypes[race] = type; }
+            if (type.isRefinery()       && refineryActionTypes[race] == ActionTypes::None)         { refineryActionTypes[race] = type; }
+            if (type.isSupplyProvider() && supplyProviderActionTypes[race] == ActionTypes::None)   { supplyProviderActionTypes[race] = type; }
+
+            // the depot a race starts with, not one of the depots morphed or upgraded from it
+            if (type.isDepot() && !type.whatBuilds().isDepot() && resourceDepotActionTypes[race] == ActionTypes::None)
+            {
+                resourceDepotActionTypes[race] = type;
+            }
+        }
+
+        // a race whose worker is morphed from larva, which is spawned by its hatchery
+        for (RaceID race(0); race < Races::NUM_RACES; ++race)
+        {
+            const ActionType worker = workerActionTypes[race];
+            if (worker != ActionTypes::None && worker.isMorphed())
+            {
+                larvaActionTypes[race] = worker.whatBuilds();
+                hatcheryActionTypes[race] = worker.whatBuilds().whatBuilds();
+            }
+        }
+
+        for (RaceID race(0); race < Races::NUM_RACES; ++race)
+        {
+            BOSS_ASSERT(workerActionTypes[race] != ActionTypes::None, "No worker type in the data file for %s", Races::GetRaceName(race).c_str());
+            BOSS_ASSERT(resourceDepotActionTypes[race] != ActionTypes::None, "No resource depot type in the data file for %s", Races::GetRaceName(race).c_str());
+        }
+    }
+
+    void InitHotData()
+    {
+        allActionHotData.clear();
+        for (const ActionTypeData & data : ActionTypeData::GetAllActionTypeData())
+        {
+            ActionTypeHotData hot;
+            hot.buildTime       = data.buildTime;
+            hot.mineralCost     = static_cast<int16_t>(data.mineralCost);
+            hot.gasCost         = static_cast<int16_t>(data.gasCost);
+            hot.supplyCost      = static_cast<int16_t>(data.supplyCost);
+            hot.supplyProvided  = static_cast<int16_t>(data.supplyProvided);
+            hot.buildLimit      = static_cast<int16_t>(data.buildLimit);
+            hot.whatBuilds      = static_cast<uint16_t>(data.whatBuilds.getID());
+            hot.whatBuildsAddon = static_cast<uint16_t>(data.whatBuildsAddon.getID());
+            hot.whatBuildsCount = static_cast<uint8_t>(data.whatBuildsCount);
+            hot.race            = static_cast<uint8_t>(data.race);
+
+            BOSS_ASSERT(hot.mineralCost == data.mineralCost && hot.gasCost == data.gasCost && hot.supplyCost == data.supplyCost &&
+                        hot.supplyProvided == data.supplyProvided && hot.buildLimit == data.buildLimit && hot.whatBuildsCount == data.whatBuildsCount,
+                        "A value of %s doesn't fit in the packed ActionType data", data.name.c_str());
+
+            const std::pair<bool, ActionTypeHotData::Flags> flags[] =
+            {
+                { data.isUnit,                       ActionTypeHotData::IsUnit },
+                { data.isUpgrade || data.isTech,     ActionTypeHotData::IsUpgrade },
+                { data.isAbility,                    ActionTypeHotData::IsAbility },
+                { data.isBuilding,                   ActionTypeHotData::IsBuilding },
+                { data.isWorker,                     ActionTypeHotData::IsWorker },
+                { data.isRefinery,                   ActionTypeHotData::IsRefinery },
+                { data.isSupplyProvider,             ActionTypeHotData::IsSupplyProvider },
+                { data.isDepot,                      ActionTypeHotData::IsDepot },
+                { data.isAddon,                      ActionTypeHotData::IsAddon },
+                { data.isHatchery,                   ActionTypeHotData::IsHatchery },
+                { data.isMorphed,                    ActionTypeHotData::IsMorphed },
+                { data.isTech,                       ActionTypeHotData::IsTech }
+            };
+
+            for (const auto & flag : flags)
+            {
+                hot.flags |= flag.first ? flag.second : 0;
+            }
+
+            allActionHotData.push_back(hot);
+        }
+    }
+
+    void InitMasks()
+    {
+        allActionEquivalentMasks.assign(allActionTypes.size(), ActionBits());
+        allActionRequiredMasks.assign(allActionTypes.size(), std::vector<ActionBits>());
+
+        for (const ActionType & type : allActionTypes)
+        {
+            allActionEquivalentMasks[type.getID()].set(type.getID());
+            for (const ActionType & equivalent : type.equivalent())
+            {
+                allActionEquivalentMasks[type.getID()].set(equivalent.getID());
+            }
+        }
+
+        for (const ActionType & type : allActionTypes)
+        {
+            for (const ActionType & required : type.required())
+            {
+                allActionRequiredMasks[type.getID()].push_back(allActionEquivalentMasks[required.getID()]);
+            }
+        }
+    }
 
     void Init()
     {
+        BOSS_ASSERT(ActionTypeData::GetAllActionTypeData().size() <= BOSS_MAX_ACTION_TYPES, "%zu action types is more than BOSS_MAX_ACTION_TYPES (%d)", ActionTypeData::GetAllActionTypeData().size(), BOSS_MAX_ACTION_TYPES);
+
+        // the accessors read the packed data, so it has to be built before anything below uses them
+        InitHotData();
+
         for (size_t i(0); i < ActionTypeData::GetAllActionTypeData().size(); ++i)
         {
             allActionTypes.push_back(ActionType(i));
             nameMap[allActionTypes[i].getName()] = allActionTypes[i];
         }
 
-        workerActionTypes.push_back(ActionTypes::GetActionType("Probe"));
-        refineryActionTypes.push_back(ActionTypes::GetActionType("Assimilator"));
-        supplyProviderActionTypes.push_back(ActionTypes::GetActionType("Pylon"));
-        resourceDepotActionTypes.push_back(ActionTypes::GetActionType("Nexus"));
-
-        workerActionTypes.push_back(ActionTypes::GetActionType("SCV"));
-        refineryActionTypes.push_back(ActionTypes::GetActionType("Refinery"));
-        supplyProviderActionTypes.push_back(ActionTypes::GetActionType("SupplyDepot"));
-        resourceDepotActionTypes.push_back(ActionTypes::GetActionType("CommandCenter"));
+        InitRoles();
 
-        workerActionTypes.push_back(ActionTypes::GetActionType("Drone"));
-        refineryActionTypes.push_back(ActionTypes::GetActionType("Extractor"));
-        supplyProviderActionTypes.push_back(ActionTypes::GetActionType("Overlord"));
-        resourceDepotActionTypes.push_back(ActionTypes::GetActionType("Hatchery"));
+        InitMasks();
 
         // calculate all action prerequisites
         for (size_t i(0); i < allActionTypes.size(); ++i)
@@ -157,24 +302,40 @@ namespace ActionTypes
         }
     }
 
+    // Races::None has no roles, it is the race of ActionTypes::None which a unit can morph into
+    ActionType RoleForRace(const std::vector<ActionType> & roles, const RaceID raceID)
+    {
+        return raceID < roles.size() ? roles[raceID] : ActionTypes::None;
+    }
+
     ActionType GetWorker(const RaceID raceID)
     {
-        return workerActionTypes[raceID];
+        return RoleForRace(workerActionTypes, raceID);
     }
 
     ActionType GetSupplyProvider(const RaceID raceID)
     {
-        return supplyProviderActionTypes[raceID];
+        return RoleForRace(supplyProviderActionTypes, raceID);
     }
 
     ActionType GetRefinery(const RaceID raceID)
     {
-        return refineryActionTypes[raceID];
+        return RoleForRace(refineryActionTypes, raceID);
     }
 
     ActionType GetResourceDepot(const RaceID raceID)
     {
-        return resourceDepotActionTypes[raceID];
+        return RoleForRace(resourceDepotActionTypes, raceID);
+    }
+
+    ActionType GetLarva(const RaceID raceID)
+    {
+        return RoleForRace(larvaActionTypes, raceID);
+    }
+
+    ActionType GetHatchery(const RaceID raceID)
+    {
+        return RoleForRace(hatcheryActionTypes, raceID);
     }
     
     ActionType GetActionType(const std::string & name)
@@ -8,7 +8,7 @@ namespace BOSS
 
 class ActionType
 {
-    const ActionID m_id = 0;
+    uint16_t m_id = 0;      // stored narrow since every Unit holds several, BOSS_MAX_ACTION_TYPES fits easily
 
 public:
 
@@ -16,7 +16,6 @@ public:
     ActionType(const ActionID actionID);
     ActionType(const std::string & str);
 
-    ActionType & operator = (const ActionType & rhs);
     const std::string & getName()       const;
 
     ActionID getID()        const;
@@ -47,6 +46,8 @@ public:
     int whatBuildsCount() const;
     const std::vector<ActionType> & required() const;
     const std::vector<ActionType> & equivalent() const;
+    const ActionBits & equivalentMask() const;
+    const std::vector<ActionBits> & requiredMasks() const;
     const ActionSet & getPrerequisiteActionCount() const;
     const ActionSet & getRecursivePrerequisiteActionCount() const;
     bool operator == (const ActionType rhs)     const;
@@ -63,6 +64,8 @@ namespace ActionTypes
     ActionType GetSupplyProvider(const RaceID raceID);
     ActionType GetRefinery(const RaceID raceID);
     ActionType GetResourceDepot(const RaceID raceID);
+    ActionType GetLarva(const RaceID raceID);
+    ActionType GetHatchery(const RaceID raceID);
     ActionType GetActionType(const std::string & name);
     bool       TypeExists(const std::string & name);
 
@@ -1,16 +1,23 @@
 #include "BOSS.h"
 #include "ActionType.h"
 #include "ActionTypeData.h"
+#include "HeuristicTable.h"
 
 namespace BOSS
 {
-    void Init(const std::string & filename)
+    void Init(const std::string & filename, const std::string & heuristicTableFile)
     {
         static bool isInit = false;
         if (!isInit)
         {
             ActionTypeData::Init(filename);
             ActionTypes::Init();
+
+            if (!heuristicTableFile.empty())
+            {
+                HeuristicTables::Load(heuristicTableFile);
+            }
+
             isInit = true;
         }
     }
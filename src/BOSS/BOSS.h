@@ -7,6 +7,7 @@
 
 namespace BOSS
 {
-    void Init(const std::string & filename);
+    // heuristicTableFile is optional, see HeuristicTables::Load
+    void Init(const std::string & filename, const std::string & heuristicTableFile = "");
     
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <cstdint>
 #include <math.h>
 #include <fstream>
 #include <fstream>
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace BOSS
+{
+
+// shared time limit / cancellation flag for the searches
+// a background thread sleeps until the time limit and then sets the flag, so a search only
+// has to test expired() in its inner loop instead of reading the clock, and can unwind normally
+class Deadline
+{
+    std::atomic<bool>       m_expired   { false };  // set once the time limit is reached or cancel() is called
+    bool                    m_stopTimer = false;    // tells the timer thread to exit early, guarded by m_mutex
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::thread             m_timerThread;
+
+public:
+
+    Deadline() {}
+    Deadline(const Deadline &) = delete;
+    Deadline & operator = (const Deadline &) = delete;
+
+    ~Deadline()
+    {
+        stop();
+    }
+
+    // clears the flag and expires it timeLimitMS from now, a time limit of 0 never expires on its own
+    void start(const double timeLimitMS)
+    {
+        stop();
+        m_expired = false;
+
+        if (timeLimitMS <= 0)
+        {
+            return;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(timeLimitMS * 1000));
+
+        m_stopTimer = false;
+        m_timerThread = std::thread([this, deadline]()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_condition.wait_until(lock, deadline, [this]() { return m_stopTimer; }))
+            {
+                m_expired.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // stops the timer thread without expiring the flag, call when the search is finished
+    void stop()
+    {
+        if (!m_timerThread.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopTimer = true;
+        }
+
+        m_condition.notify_all();
+        m_timerThread.join();
+    }
+
+    // expires the flag right away, can be called from any thread
+    void cancel()
+    {
+        m_expired.store(true, std::memory_order_relaxed);
+    }
+
+    bool expired() const
+    {
+        return m_expired.load(std::memory_order_relaxed);
+    }
+};
+
+}
@@ -1,6 +1,7 @@
 #include "GameState.h"
 #include <numeric>
 #include <iomanip>
+#include <tuple>
 
 using namespace BOSS;
 
@@ -9,10 +10,28 @@ const int MPWPF = 45;
 const int GPWPF = 70;
 const int WorkersPerRefinery = 3;
 
+// splitmix64 finalizer, used to give every hashed value a well spread 64 bit key
+static uint64_t Mix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// zobrist key of one unit of the given type, units are summed so that duplicates don't cancel out
+static uint64_t UnitHash(const size_t typeID, const bool completed)
+{
+    return Mix64((static_cast<uint64_t>(typeID) << 1) | (completed ? 1 : 0));
+}
+
 GameState::GameState()
-    : m_minerals        (0)
-    , m_gas             (0)
+    : m_numTotal        (ActionTypes::GetAllActionTypes().size(), 0)
+    , m_numCompleted    (ActionTypes::GetAllActionTypes().size(), 0)
+    , m_numInProgress   (ActionTypes::GetAllActionTypes().size(), 0)
     , m_race            (Races::None)
+    , m_minerals        (0)
+    , m_gas             (0)
     , m_currentSupply   (0)
     , m_maxSupply       (0)
     , m_currentFrame    (0)
@@ -40,7 +59,7 @@ bool GameState::isLegal(const ActionType action) const
 {
     if (action.getRace() != m_race) { return false; }
 
-    static const ActionType larva("Larva");
+    const ActionType larva = ActionTypes::GetLarva(m_race);
     if (action == larva) { return false; }
 
     const size_t mineralWorkers = m_mineralWorkers + m_buildingWorkers;
@@ -125,6 +144,93 @@ void GameState::doAction(const ActionType type)
     addUnit(type, builderIDs);
 }
 
+// does the action while recording everything it changes into the journal, so undoAction can reverse it
+// a journal can record several actions in a row, undoAction then returns to the state before the first one
+void GameState::doAction(const ActionType type, UndoJournal & journal)
+{
+    if (!journal.m_recorded)
+    {
+        journal.m_recorded          = true;
+        journal.m_numUnits          = m_units.size();
+        journal.m_units.clear();
+        journal.m_unitsBeingBuilt   = m_unitsBeingBuilt;
+        journal.m_minerals          = m_minerals;
+        journal.m_gas               = m_gas;
+        journal.m_currentSupply     = m_currentSupply;
+        journal.m_maxSupply         = m_maxSupply;
+        journal.m_currentFrame      = m_currentFrame;
+        journal.m_previousFrame     = m_previousFrame;
+        journal.m_mineralWorkers    = m_mineralWorkers;
+        journal.m_gasWorkers        = m_gasWorkers;
+        journal.m_buildingWorkers   = m_buildingWorkers;
+        journal.m_numRefineries     = m_numRefineries;
+        journal.m_numDepots         = m_numDepots;
+    }
+
+    m_journal = &journal;
+    doAction(type);
+    m_journal = nullptr;
+}
+
+// restores the state to exactly what it was before the actions recorded in the journal were done
+void GameState::undoAction(const UndoJournal & journal)
+{
+    if (!journal.m_recorded) { return; }
+
+    // take the current version of every changed unit out of the per-type counters
+    for (size_t id : m_unitsBeingBuilt)
+    {
+        m_numInProgress[m_units[id].getType().getID()]--;
+    }
+
+    for (size_t i(journal.m_numUnits); i < m_units.size(); ++i)
+    {
+        uncountUnit(m_units[i]);
+    }
+
+    for (const Unit & unit : journal.m_units)
+    {
+        uncountUnit(m_units[unit.getID()]);
+    }
+
+    // then put back the previous versions
+    m_units.truncate(journal.m_numUnits);
+    for (const Unit & unit : journal.m_units)
+    {
+        m_units[unit.getID()] = unit;
+        countUnit(unit);
+    }
+
+    m_unitsBeingBuilt = journal.m_unitsBeingBuilt;
+    for (size_t id : m_unitsBeingBuilt)
+    {
+        m_numInProgress[m_units[id].getType().getID()]++;
+    }
+
+    m_minerals          = journal.m_minerals;
+    m_gas               = journal.m_gas;
+    m_currentSupply     = journal.m_currentSupply;
+    m_maxSupply         = journal.m_maxSupply;
+    m_currentFrame      = journal.m_currentFrame;
+    m_previousFrame     = journal.m_previousFrame;
+    m_mineralWorkers    = journal.m_mineralWorkers;
+    m_gasWorkers        = journal.m_gasWorkers;
+    m_buildingWorkers   = journal.m_buildingWorkers;
+    m_numRefineries     = journal.m_numRefineries;
+    m_numDepots         = journal.m_numDepots;
+}
+
+void UndoJournal::clear()
+{
+    m_recorded = false;
+    m_units.clear();
+}
+
+bool UndoJournal::empty() const
+{
+    return !m_recorded;
+}
+
 void GameState::fastForward(const int toFrame)
 {
     if (toFrame == m_currentFrame) { return; }
@@ -139,7 +245,7 @@ void GameState::fastForward(const int toFrame)
     // that way for ease of deleting the finished ones
     while (!m_unitsBeingBuilt.empty())
     {
-        Unit & unit = getUnit(m_unitsBeingBuilt.back());
+        const Unit & unit = m_units[m_unitsBeingBuilt.back()];
         ActionType type = unit.getType();
 
         // if the current action in progress will finish after the ff time, we can stop
@@ -161,6 +267,7 @@ void GameState::fastForward(const int toFrame)
 
         // register the action and remove it from the list
         completeUnit(unit);
+        m_numInProgress[type.getID()]--;
         m_unitsBeingBuilt.pop_back();
     }
 
@@ -169,37 +276,51 @@ void GameState::fastForward(const int toFrame)
     m_minerals      += timeElapsed * MPWPF * m_mineralWorkers;
     m_gas           += timeElapsed * GPWPF * m_gasWorkers;
 
-    // update all the intances to the ff time
-    std::map<int, std::vector<size_t>> larvae;
+    // update all the intances to the ff time, recording (frames remaining, unit index) for each larva spawned
+    // the list stays empty (and unallocated) unless a hatchery actually spawns larva during this time
+    std::vector<std::pair<int, size_t>> larvae;
+    const int frames = toFrame - previousFrame;
+    int larvaToAdd[3];
     for (size_t i = 0; i < m_units.size(); i++)
     {
-        m_units[i].fastForward(toFrame - previousFrame);
-        for (auto l : m_units[i].larvaToAdd())
+        if (m_units[i].isIdle()) { continue; }
+
+        Unit & unit = getUnit(i);
+
+        const bool wasCompleted = unit.getTimeUntilBuilt() == 0;
+        const int numLarvaToAdd = unit.fastForward(frames, larvaToAdd);
+        if (!wasCompleted && unit.getTimeUntilBuilt() == 0)
         {
-            larvae[l].push_back(i);
+            countCompletion(unit);
+        }
+
+        for (int l = 0; l < numLarvaToAdd; l++)
+        {
+            larvae.emplace_back(larvaToAdd[l], i);
         }
-        m_units[i].larvaToAdd().clear();
     }
 
-    // Add larva in order
-    static const ActionType larva("Larva");
-    for (auto iter = larvae.rbegin(); iter != larvae.rend(); ++iter)
+    // add larva in the order they spawned, ties broken by unit index
+    std::stable_sort(larvae.begin(), larvae.end(), [](const auto & a, const auto & b) { return a.first > b.first; });
+    const ActionType larva = ActionTypes::GetLarva(m_race);
+    for (auto & [framesRemaining, i] : larvae)
     {
-        for (size_t i : iter->second)
+        addUnit(larva, static_cast<int>(m_units[i].getID()));
+        if (framesRemaining + previousFrame != toFrame)
         {
-            addUnit(larva, static_cast<int>(m_units[i].getID()));
-            if (iter->first + previousFrame != toFrame)
+            auto& newLarva = m_units.back();
+            if (newLarva.getTimeUntilBuilt() > 0)
             {
-                auto& newLarva = m_units.back();
-                newLarva.complete();
+                countCompletion(newLarva);
             }
+            newLarva.complete();
         }
     }
 
     m_currentFrame = toFrame;
 }
 
-void GameState::completeUnit(Unit & unit)
+void GameState::completeUnit(const Unit & unit)
 {
     m_maxSupply += unit.getType().supplyProvided();
 
@@ -234,12 +355,13 @@ void GameState::addUnit(const ActionType type, int builderID)
 
     m_race = static_cast<int>(type.getRace());
     
-    static const ActionType larva("Larva");
+    const ActionType larva = ActionTypes::GetLarva(m_race);
     if (type == larva)
     {
         BOSS_ASSERT(builderID != -1, "Larva must have a valid builder (hatchery) ID");
         Unit unit(type, m_units.size(), builderID);
         m_units.push_back(unit);
+        countUnit(unit);
         getUnit(builderID).addLarva();
     }
     // if there's no builder, complete the unit now and skip the unit in progress step
@@ -247,14 +369,13 @@ void GameState::addUnit(const ActionType type, int builderID)
     {
         Unit unit(type, m_units.size(), builderID); // unit is completed in constructor
         m_units.push_back(unit);
+        countUnit(unit);
         completeUnit(unit);
 
         m_currentSupply += type.supplyCost();
 
         // if it's a hatchery, add 3 larva
-        static const ActionType hatchery("Hatchery");
-        static const ActionType larva("Larva");
-        if (unit.getType() == hatchery)
+        if (unit.getType() == ActionTypes::GetHatchery(m_race))
         {
             addUnit(larva, static_cast<int>(unit.getID()));
             addUnit(larva, static_cast<int>(unit.getID()));
@@ -277,7 +398,9 @@ void GameState::addUnit(const ActionType type, int builderID)
                 getUnit(static_cast<size_t>(builder.getBuilderID())).useLarva();
             }
 
+            uncountUnit(builder);
             builder.startMorphing(type);
+            countUnit(builder);
             unitBeingBuiltID = static_cast<int>(builder.getID());
         }
         // if it's non-morphed, then we need a new unit
@@ -285,17 +408,19 @@ void GameState::addUnit(const ActionType type, int builderID)
         {
             Unit unit(type, m_units.size(), builderID);
             m_units.push_back(unit);
+            countUnit(unit);
             getUnit(builderID).startBuilding(m_units.back());
             unitBeingBuiltID = static_cast<int>(unit.getID());
         }
 
         // add the unit ID being built and sort the list
         m_unitsBeingBuilt.push_back(unitBeingBuiltID);
+        m_numInProgress[type.getID()]++;
 
         // we know the list is already sorted when we add this unit, so we just swap it from the end until it's in the right place
         for (size_t i = m_unitsBeingBuilt.size() - 1; i > 0; i--)
         {
-            if (getUnit(m_unitsBeingBuilt[i]).getTimeUntilBuilt() > getUnit(m_unitsBeingBuilt[i - 1]).getTimeUntilBuilt())
+            if (m_units[m_unitsBeingBuilt[i]].getTimeUntilBuilt() > m_units[m_unitsBeingBuilt[i - 1]].getTimeUntilBuilt())
             {
                 std::swap(m_unitsBeingBuilt[i], m_unitsBeingBuilt[i - 1]);
             }
@@ -329,8 +454,10 @@ void GameState::addUnit(const ActionType type, const std::vector<int> & builderI
         {
             Unit & extraBuilder = getUnit(builderIDs[i]);
             BOSS_ASSERT(extraBuilder.whenCanBuild(type) != -1, "Extra builder cannot build %s", type.getName().c_str());
+            uncountUnit(extraBuilder);
             extraBuilder.startMorphing(ActionTypes::None);
             extraBuilder.complete();
+            countUnit(extraBuilder);
         }
     }
 }
@@ -441,9 +568,9 @@ int GameState::whenResourcesReady(const ActionType action) const
 
 int GameState::whenBuilderReady(const ActionType action) const
 {
-    static const ActionType larva("Larva");
-    static const ActionType hatchery("Hatchery");
-    
+    const ActionType larva = ActionTypes::GetLarva(m_race);
+    const ActionType hatchery = ActionTypes::GetHatchery(m_race);
+
     // if what builds this is a larva, we have to check when the next one will appear
     if (action.whatBuilds() == larva)
     {
@@ -515,8 +642,16 @@ int GameState::whenPrerequisitesReady(const ActionType action) const
 
     // if it has prerequisites, we need to find the max-min time that any of the prereqs are free
     int whenPrereqReady = 0;
-    for (auto & req : action.required())
+    const std::vector<ActionBits> & requiredMasks = action.requiredMasks();
+    for (size_t r(0); r < requiredMasks.size(); ++r)
     {
+        // a completed unit of the required type or an equivalent one means it's ready now
+        if ((m_typesCompleted & requiredMasks[r]).any())
+        {
+            continue;
+        }
+
+        const ActionType req = action.required()[r];
 
         // find the minimum time that this particular prereq will be ready
         int minReady = std::numeric_limits<int>::max();
@@ -619,48 +754,136 @@ bool GameState::haveBuilder(const ActionType type) const
            [&type](const Unit & u){ return u.whenCanBuild(type) != -1; });
 }
 
+// each required type is met by a unit of it or of one of its equivalents
 bool GameState::havePrerequisites(const ActionType type) const
 {
-    return std::all_of(type.required().begin(), type.required().end(), 
-           [this](const ActionType & req) 
-        { 
-            if (this->haveType(req))
-            {
-                return true;
-            }
-            for (auto& equi : req.equivalent())
-            {
-                if (this->haveType(equi))
-                {
-                    return true;
-                }
-            }
+    for (const ActionBits & required : type.requiredMasks())
+    {
+        if ((m_typesPresent & required).none())
+        {
             return false;
-        });
+        }
+    }
+
+    return true;
 }
 
+// the per-type counters are kept up to date by addUnit and fastForward, so these queries are a single lookup
 size_t GameState::getNumInProgress(const ActionType action) const
 {
-    return std::count_if(m_unitsBeingBuilt.begin(), m_unitsBeingBuilt.end(),
-           [this, &action](const size_t & id) { return action == this->getUnit(id).getType(); } );
+    return action.getID() < m_numInProgress.size() ? m_numInProgress[action.getID()] : 0;
 }
 
 size_t GameState::getNumCompleted(const ActionType action) const
 {
-    return std::count_if(m_units.begin(), m_units.end(),
-           [&action](const Unit & unit) { return action == unit.getType() && unit.getTimeUntilBuilt() == 0; } );
+    return action.getID() < m_numCompleted.size() ? m_numCompleted[action.getID()] : 0;
 }
 
 size_t GameState::getNumTotal(const ActionType action) const
 {
-    return std::count_if(m_units.begin(), m_units.end(), 
-           [&action](const Unit & unit) { return action == unit.getType(); } );
+    return action.getID() < m_numTotal.size() ? m_numTotal[action.getID()] : 0;
 }
 
 bool GameState::haveType(const ActionType action) const
 {
-    return std::any_of(m_units.begin(), m_units.end(), 
-           [&action](const Unit & i){ return i.getType() == action; });
+    return getNumTotal(action) > 0;
+}
+
+// registers a unit in the per-type counters, must be called whenever a unit is added or changes type
+void GameState::countUnit(const Unit & unit)
+{
+    const size_t id = unit.getType().getID();
+    if (id >= m_numTotal.size())
+    {
+        const size_t numTypes = std::max(id + 1, ActionTypes::GetAllActionTypes().size());
+        m_numTotal.resize(numTypes, 0);
+        m_numCompleted.resize(numTypes, 0);
+        m_numInProgress.resize(numTypes, 0);
+    }
+
+    m_numTotal[id]++;
+    m_typesPresent.set(id);
+    if (unit.getTimeUntilBuilt() == 0) { m_numCompleted[id]++; m_typesCompleted.set(id); }
+    m_unitHash += UnitHash(id, unit.getTimeUntilBuilt() == 0);
+}
+
+// removes a unit from the per-type counters, call before changing the type or build time of a unit
+void GameState::uncountUnit(const Unit & unit)
+{
+    const size_t id = unit.getType().getID();
+    m_numTotal[id]--;
+    if (m_numTotal[id] == 0) { m_typesPresent.reset(id); }
+    if (unit.getTimeUntilBuilt() == 0 && --m_numCompleted[id] == 0) { m_typesCompleted.reset(id); }
+    m_unitHash -= UnitHash(id, unit.getTimeUntilBuilt() == 0);
+}
+
+// moves an in-progress unit to completed in the counters, call when its build time reaches zero
+void GameState::countCompletion(const Unit & unit)
+{
+    const size_t id = unit.getType().getID();
+    m_numCompleted[id]++;
+    m_typesCompleted.set(id);
+    m_unitHash += UnitHash(id, true) - UnitHash(id, false);
+}
+
+// the unit part of the hash is kept up to date by countUnit, uncountUnit and countCompletion
+// everything else is small enough to mix in when asked: the in-progress list is usually only a few units
+uint64_t GameState::hash() const
+{
+    uint64_t h = m_unitHash;
+    for (const int value : { m_currentFrame, m_minerals, m_gas, m_currentSupply, m_maxSupply, m_mineralWorkers, m_gasWorkers, m_buildingWorkers })
+    {
+        h = Mix64(h ^ static_cast<uint32_t>(value));
+    }
+
+    // units in progress are added by type and the frame they finish on, which does not change as the state moves forward
+    uint64_t inProgress = 0;
+    for (const size_t id : m_unitsBeingBuilt)
+    {
+        const Unit & unit = m_units[id];
+        inProgress += Mix64((static_cast<uint64_t>(m_currentFrame + unit.getTimeUntilBuilt()) << 32) ^ unit.getType().getID());
+    }
+
+    // a unit that is busy, has larva or has an addon isn't described by its type alone, so everything else about it is added too
+    // the searches use the hash as an exact state key, so two states may only share it if they really are the same
+    uint64_t details = 0;
+    for (const Unit & unit : m_units)
+    {
+        if (unit.isIdle() && unit.numLarva() == 0 && !unit.hasAddon())
+        {
+            continue;
+        }
+
+        const uint64_t types  = (static_cast<uint64_t>(unit.getType().getID()) << 48) | (static_cast<uint64_t>(unit.getAddon().getID()) << 32)
+                              | (static_cast<uint64_t>(unit.getBuildType().getID()) << 16) | (static_cast<uint64_t>(unit.numLarva()) << 8);
+        const uint64_t timers = (static_cast<uint64_t>(static_cast<uint32_t>(unit.getTimeUntilFree())) << 32) | static_cast<uint32_t>(unit.timeUntilLarva());
+        details += Mix64(Mix64(types) ^ timers);
+    }
+
+    return Mix64(Mix64(h ^ inProgress) ^ details);
+}
+
+// everything hash describes, with types by name and units sorted, so it doesn't depend on type IDs or the order units were made in
+std::string GameState::getNameKey() const
+{
+    std::vector<std::string> units;
+    for (const Unit & unit : m_units)
+    {
+        std::stringstream ss;
+        ss << unit.getType().getName() << " " << unit.getTimeUntilBuilt() << " " << unit.getTimeUntilFree() << " " << unit.getBuildType().getName()
+           << " " << unit.getAddon().getName() << " " << unit.numLarva() << " " << unit.timeUntilLarva();
+        units.push_back(ss.str());
+    }
+    std::sort(units.begin(), units.end());
+
+    std::stringstream ss;
+    ss << Races::GetRaceName(m_race) << " " << m_currentFrame << " " << m_minerals << " " << m_gas << " " << m_mineralWorkers << " " << m_gasWorkers << " " << m_buildingWorkers;
+    for (const std::string & unit : units)
+    {
+        ss << "\n" << unit;
+    }
+
+    return ss.str();
 }
 
 int GameState::getSupplyInProgress() const
@@ -679,8 +902,18 @@ const Unit & GameState::getUnit(const size_t id) const
     return m_units[id];
 }
 
+// every change to an existing unit goes through here, so it is where the undo journal records previous values
 Unit & GameState::getUnit(const size_t & id)
 {
+    if (m_journal && id < m_journal->m_numUnits)
+    {
+        const auto & journaled = m_journal->m_units;
+        if (std::none_of(journaled.begin(), journaled.end(), [id](const Unit & unit) { return unit.getID() == id; }))
+        {
+            m_journal->m_units.push_back(m_units[id]);
+        }
+    }
+
     return m_units[id];
 }
 
@@ -694,6 +927,17 @@ int GameState::getGas() const
     return (int)(m_gas / ResourceScale);
 }
 
+// what one worker gathers each frame, in the same units as getMinerals and getGas
+double GameState::getMineralsPerWorkerFrame() const
+{
+    return (double)MPWPF / ResourceScale;
+}
+
+double GameState::getGasPerWorkerFrame() const
+{
+    return (double)GPWPF / ResourceScale;
+}
+
 int GameState::getCurrentSupply() const
 {
     return m_currentSupply;
@@ -721,7 +965,7 @@ void GameState::setGas(const int gas)
 
 bool BOSS::GameState::operator==(const GameState& rhs) const
 {
-    return tie(m_units, m_unitsBeingBuilt, m_race, m_minerals, m_gas, m_currentSupply, m_maxSupply, m_currentFrame, m_mineralWorkers, m_gasWorkers, m_buildingWorkers, m_numRefineries, m_numDepots, m_previousAction) == tie(rhs.m_units, rhs.m_unitsBeingBuilt, rhs.m_race, rhs.m_minerals, rhs.m_gas, rhs.m_currentSupply, rhs.m_maxSupply, rhs.m_currentFrame, rhs.m_mineralWorkers, rhs.m_gasWorkers, rhs.m_buildingWorkers, rhs.m_numRefineries, rhs.m_numDepots, rhs.m_previousAction);
+    return std::tie(m_units, m_unitsBeingBuilt, m_race, m_minerals, m_gas, m_currentSupply, m_maxSupply, m_currentFrame, m_mineralWorkers, m_gasWorkers, m_buildingWorkers, m_numRefineries, m_numDepots, m_previousAction) == std::tie(rhs.m_units, rhs.m_unitsBeingBuilt, rhs.m_race, rhs.m_minerals, rhs.m_gas, rhs.m_currentSupply, rhs.m_maxSupply, rhs.m_currentFrame, rhs.m_mineralWorkers, rhs.m_gasWorkers, rhs.m_buildingWorkers, rhs.m_numRefineries, rhs.m_numDepots, rhs.m_previousAction);
 }
 
 int GameState::getRace() const
@@ -913,7 +1157,7 @@ std::string GameState::toStringCompleted() const
     return ss.str();
 }
 
-const std::vector<Unit>& GameState::getUnits() const
+const UnitVector & GameState::getUnits() const
 {
     return m_units;
 }
@@ -3,13 +3,76 @@
 #include "Common.h"
 #include "ActionType.h"
 #include "Unit.h"
+#include "InlineVector.hpp"
+
+#include <cstdint>
+
+// capacities of the storage held inside each GameState so that copying a state does not touch the heap
+// a state which grows past these still works, it just falls back to heap storage for that container
+// every stored search node pays for the full capacity, so these cover a typical opening rather than the largest state
+#ifndef BOSS_INLINE_UNITS
+#define BOSS_INLINE_UNITS 32
+#endif
+
+#ifndef BOSS_INLINE_UNITS_IN_PROGRESS
+#define BOSS_INLINE_UNITS_IN_PROGRESS 16
+#endif
+
+#ifndef BOSS_INLINE_ACTION_TYPES
+#define BOSS_INLINE_ACTION_TYPES 128
+#endif
+
+// units an UndoJournal can record the old values of before it moves them to the heap, usually just a builder or two
+#ifndef BOSS_INLINE_JOURNAL_UNITS
+#define BOSS_INLINE_JOURNAL_UNITS 8
+#endif
 
 namespace BOSS
 {
+
+typedef InlineVector<Unit, BOSS_INLINE_UNITS> UnitVector;
+typedef InlineVector<size_t, BOSS_INLINE_UNITS_IN_PROGRESS> UnitIDVector;
+typedef InlineVector<uint16_t, BOSS_INLINE_ACTION_TYPES> ActionCountVector;
+typedef InlineVector<Unit, BOSS_INLINE_JOURNAL_UNITS> JournalUnitVector;
+
+// records what a sequence of GameState::doAction calls changed, so that GameState::undoAction
+// can restore the state they started from without having to keep a copy of the whole state
+class UndoJournal
+{
+    friend class GameState;
+
+    bool              m_recorded          = false;    // whether the state before the first action has been recorded
+    size_t            m_numUnits          = 0;        // number of units before the first action, later units are removed on undo
+    JournalUnitVector m_units;                            // previous values of existing units which were changed
+    UnitIDVector      m_unitsBeingBuilt;
+    int               m_minerals          = 0;
+    int               m_gas               = 0;
+    int               m_currentSupply     = 0;
+    int               m_maxSupply         = 0;
+    int               m_currentFrame      = 0;
+    int               m_previousFrame     = 0;
+    int               m_mineralWorkers    = 0;
+    int               m_gasWorkers        = 0;
+    int               m_buildingWorkers   = 0;
+    int               m_numRefineries     = 0;
+    int               m_numDepots         = 0;
+
+public:
+
+    void clear();
+    bool empty() const;
+};
+
 class GameState
 {
-    std::vector<Unit>	m_units;
-    std::vector<size_t>	m_unitsBeingBuilt;  // indices of m_units which are not completed, sorted descending by finish time
+    UnitVector          m_units;
+    UnitIDVector        m_unitsBeingBuilt;  // indices of m_units which are not completed, sorted descending by finish time
+    ActionCountVector   m_numTotal;         // number of units of each type, indexed by ActionID
+    ActionCountVector   m_numCompleted;     // number of completed units of each type, indexed by ActionID
+    ActionCountVector   m_numInProgress;    // number of units of each type in m_unitsBeingBuilt, indexed by ActionID
+    ActionBits          m_typesPresent;     // bit set for every type with a unit, built or not, kept in step with m_numTotal
+    ActionBits          m_typesCompleted;   // bit set for every type with a completed unit, kept in step with m_numCompleted
+    uint64_t            m_unitHash  = 0;    // sum of the zobrist keys of every unit's type and completion status
     int m_race              = Races::None;
     int m_minerals          = 0;
     int m_gas               = 0;
@@ -23,6 +86,7 @@ class GameState
     int m_numRefineries     = 0;
     int m_numDepots         = 0;
     ActionType m_previousAction    = ActionTypes::None;
+    UndoJournal * m_journal = nullptr;      // journal that changes are recorded to while doAction runs, if any
     
     
     Unit &  getUnit(const size_t & id);
@@ -35,7 +99,10 @@ class GameState
     int     whenResourcesReady(const ActionType action)     const;
     int     whenBuilderReady(const ActionType action)       const;
     int     scaleResource(int baseResourceValue)            const;
-    void    completeUnit(Unit & Unit);
+    void    completeUnit(const Unit & Unit);
+    void    countUnit(const Unit & unit);
+    void    uncountUnit(const Unit & unit);
+    void    countCompletion(const Unit & unit);
 
 public:
 
@@ -44,6 +111,8 @@ public:
     const Unit &  getUnit(const size_t id)              const;
     int     getMinerals()                               const;
     int     getGas()                                    const;
+    double  getMineralsPerWorkerFrame()                 const;
+    double  getGasPerWorkerFrame()                      const;
     int     getCurrentSupply()                          const;
     int     getMaxSupply()                              const;
     int     getCurrentFrame()                           const;
@@ -61,9 +130,13 @@ public:
     bool    isLegal(const ActionType type)              const;
     bool    haveType(const ActionType action)           const;
     int     getRace()                                   const;
+    uint64_t hash()                                     const;
+    std::string getNameKey()                            const; // exact like hash, but by type name so it survives data file ID changes
     void    getLegalActions(std::vector<ActionType> & legalActions) const;
 
     void    doAction(const ActionType type);
+    void    doAction(const ActionType type, UndoJournal & journal);
+    void    undoAction(const UndoJournal & journal);
     void    fastForward(const int frames);
     void    addUnit(const ActionType unit, int builderID = -1);
     void    addUnit(const ActionType unit, const std::vector<int> & builderIDs);
@@ -80,6 +153,6 @@ public:
     std::string toStringCompleted() const;
     std::string toStringLegalActions() const;
 
-    const std::vector<Unit>& getUnits() const;
+    const UnitVector & getUnits() const;
 };
 }
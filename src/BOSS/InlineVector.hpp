@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+namespace BOSS
+{
+
+// A vector of trivially copyable elements which keeps its first N elements inside the object itself.
+// Copying one that fits within N is a single memcpy with no heap allocation, which is what makes
+// copying a GameState cheap during search. If more than N elements are added, the contents are moved
+// to the heap and it behaves like a normal vector from then on.
+template <class T, size_t N>
+class InlineVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "InlineVector elements must be trivially copyable");
+
+    size_t  m_size      = 0;
+    size_t  m_capacity  = N;
+    T *     m_heap      = nullptr;
+    alignas(T) unsigned char m_inline[N * sizeof(T)];
+
+    T *         data()          { return m_heap ? m_heap : reinterpret_cast<T *>(m_inline); }
+    const T *   data()    const { return m_heap ? m_heap : reinterpret_cast<const T *>(m_inline); }
+
+    void grow(const size_t minCapacity)
+    {
+        size_t capacity = std::max(minCapacity, m_capacity * 2);
+        T * heap = static_cast<T *>(::operator new(capacity * sizeof(T)));
+        std::memcpy(static_cast<void *>(heap), data(), m_size * sizeof(T));
+        ::operator delete(m_heap);
+        m_heap = heap;
+        m_capacity = capacity;
+    }
+
+    void copyFrom(const InlineVector & rhs)
+    {
+        if (rhs.m_size > m_capacity) { grow(rhs.m_size); }
+        std::memcpy(static_cast<void *>(data()), rhs.data(), rhs.m_size * sizeof(T));
+        m_size = rhs.m_size;
+    }
+
+public:
+
+    typedef T *                                     iterator;
+    typedef const T *                               const_iterator;
+    typedef std::reverse_iterator<iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
+
+    InlineVector()
+    {
+    }
+
+    InlineVector(const size_t size, const T & value)
+    {
+        resize(size, value);
+    }
+
+    InlineVector(const InlineVector & rhs)
+    {
+        copyFrom(rhs);
+    }
+
+    InlineVector & operator = (const InlineVector & rhs)
+    {
+        if (this != &rhs)
+        {
+            copyFrom(rhs);
+        }
+
+        return *this;
+    }
+
+    ~InlineVector()
+    {
+        ::operator delete(m_heap);
+    }
+
+    void push_back(const T & value)
+    {
+        if (m_size == m_capacity)
+        {
+            // value may refer to one of our own elements, so copy it before we move storage
+            const T copy = value;
+            grow(m_size + 1);
+            data()[m_size++] = copy;
+            return;
+        }
+
+        data()[m_size++] = value;
+    }
+
+    void resize(const size_t size, const T & value)
+    {
+        if (size > m_capacity) { grow(size); }
+        for (size_t i(m_size); i < size; ++i)
+        {
+            data()[i] = value;
+        }
+        m_size = size;
+    }
+
+    void truncate(const size_t size)                    { m_size = std::min(m_size, size); }
+    void pop_back()                                     { --m_size; }
+    void clear()                                        { m_size = 0; }
+    bool isInline()                         const       { return m_heap == nullptr; }
+    bool empty()                            const       { return m_size == 0; }
+    size_t size()                           const       { return m_size; }
+
+    T & operator [] (const size_t i)                    { return data()[i]; }
+    const T & operator [] (const size_t i)  const       { return data()[i]; }
+    T & front()                                         { return data()[0]; }
+    const T & front()                       const       { return data()[0]; }
+    T & back()                                          { return data()[m_size - 1]; }
+    const T & back()                        const       { return data()[m_size - 1]; }
+
+    iterator begin()                                    { return data(); }
+    iterator end()                                      { return data() + m_size; }
+    const_iterator begin()                  const       { return data(); }
+    const_iterator end()                    const       { return data() + m_size; }
+    reverse_iterator rbegin()                           { return reverse_iterator(end()); }
+    reverse_iterator rend()                             { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin()         const       { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()           const       { return const_reverse_iterator(begin()); }
+
+    bool operator == (const InlineVector & rhs) const
+    {
+        return m_size == rhs.m_size && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator != (const InlineVector & rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+}
@@ -2,6 +2,8 @@
 #include "GameState.h"
 #include "BuildOrderSearchGoal.h"
 
+#include <thread>
+
 using namespace BOSS;
 
 std::string JSONTools::ReadFile(const std::string & filename)
@@ -101,6 +103,17 @@ void JSONTools::ReadBool(const char * key, const json & j, bool & dest)
     }
 }
 
+// 0 threads means use every hardware thread available
+void JSONTools::ReadThreads(const char * key, const json & j, size_t & dest)
+{
+    if (j.count(key))
+    {
+        BOSS_ASSERT(j[key].is_number_integer() && j[key] >= 0, "%s should be a non-negative int", key);
+        const size_t threads = j[key];
+        dest = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
 void JSONTools::ReadString(const char * key, const json & j, std::string & dest)
 {
     if (j.count(key))
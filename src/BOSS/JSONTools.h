@@ -19,6 +19,7 @@ namespace JSONTools
     }
 
     void ReadBool(const char * key, const json & json, bool & dest);
+    void ReadThreads(const char * key, const json & json, size_t & dest);
     void ReadString(const char * key, const json & json, std::string & dest);
 
     std::string ReadFile(const std::string & filename);
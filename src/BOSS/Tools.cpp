@@ -1,6 +1,7 @@
 #include "Tools.h"
 #include "BuildOrderSearchGoal.h"
 #include "NaiveBuildOrderSearch.h"
+#include "HeuristicTable.h"
 #include "ActionSet.h"
 
 using namespace BOSS;
@@ -363,6 +364,9 @@ int Tools::GetLowerBound(const GameState & state, const BuildOrderSearchGoal & g
 
     int lowerBound = Tools::CalculatePrerequisitesLowerBound(state, wanted, 0);
 
+    // a precomputed table for this state may know a later finish
+    lowerBound = std::max(lowerBound, HeuristicTables::GetLowerBound(state, goal) - state.getCurrentFrame());
+
     return lowerBound;
 }
 
@@ -3,11 +3,11 @@
 using namespace BOSS;
 
 Unit::Unit(const ActionType type, const size_t id, int builderID)
-    : m_id              (id)
+    : m_id              (static_cast<uint32_t>(id))
+    , m_builderID       (builderID)
     , m_type            (type)
     , m_timeUntilBuilt  (builderID != -1 ? type.buildTime() : 0)
     , m_timeUntilFree   (builderID != -1 ? type.buildTime() : 0)
-    , m_builderID       (builderID)
 {
     
 }
@@ -24,7 +24,7 @@ void Unit::startBuilding(const Unit & unit)
     m_buildType = unit.getType();
 
     // record the id of the unit we're building
-    m_buildID = unit.getID();
+    m_buildID = static_cast<uint32_t>(unit.getID());
 
     // if we morph the unit, then we change into it
     if (unit.getType().isMorphed())
@@ -53,8 +53,7 @@ void Unit::startMorphing(const ActionType & type)
     // we are building ourself
     m_builderID = static_cast<int>(m_id);
 
-    static const ActionType hatchery("Hatchery");
-    if (type == hatchery && m_builderID != -1)
+    if (type != ActionTypes::None && type == ActionTypes::GetHatchery(type.getRace()) && m_builderID != -1)
     {
         m_timeUntilLarva = 1;
     }
@@ -66,9 +65,14 @@ void Unit::complete()
     m_timeUntilBuilt = 0;
 }
 
-void Unit::fastForward(const int frames)
+// fast forwards this unit's timers, returning how many larva it spawned during that time
+// the frames remaining after each larva spawned are written to larvaToAdd
+int Unit::fastForward(const int frames, int larvaToAdd[3])
 {
-    m_larvaToAdd.clear();
+    // most units in a state are finished and idle, so there is nothing to update
+    if (isIdle()) { return 0; }
+
+    int numLarvaToAdd = 0;
 
     // if we are completing the thing that this Unit is building
     if ((m_buildType != ActionTypes::None) && frames >= m_timeUntilFree)
@@ -86,7 +90,7 @@ void Unit::fastForward(const int frames)
 
     // compute the number of larva this building should have
     BOSS_ASSERT(m_numLarva < 3 || m_timeUntilLarva == 0, "Larva Error");
-    static const ActionType hatchery("Hatchery");
+    const ActionType hatchery = ActionTypes::GetHatchery(m_type.getRace());
 
     // we can only fast forward larva counters if we have a valid one
     bool ffLarva = m_timeUntilLarva > 0;
@@ -114,18 +118,20 @@ void Unit::fastForward(const int frames)
             else
             {
                 ff -= m_timeUntilLarva;
-                m_larvaToAdd.push_back(ff);
+                larvaToAdd[numLarvaToAdd++] = ff;
                 m_timeUntilLarva = 13 * 24;
             }
 
             // don't add too many larva
-            if (m_numLarva + m_larvaToAdd.size() >= 3) { break; }
+            if (m_numLarva + numLarvaToAdd >= 3) { break; }
         }
     }
 
     // subtract the amount of frames fast forwarded from our remaining times
     m_timeUntilFree = std::max(0, m_timeUntilFree - frames);
     m_timeUntilBuilt = std::max(0, m_timeUntilBuilt - frames);
+
+    return numLarvaToAdd;
 }
 
 // returns when this Unit can build a given type, -1 if it can't
@@ -241,8 +247,9 @@ void Unit::addLarva()
     if (m_numLarva == 3) { m_timeUntilLarva = 0; }
 }
 
-std::vector<int>& Unit::larvaToAdd() 
+// an idle unit is complete, not building anything and not waiting on a larva timer
+bool Unit::isIdle() const
 {
-    return m_larvaToAdd;
+    return (m_timeUntilBuilt | m_timeUntilFree | m_timeUntilLarva) == 0 && m_buildType == ActionTypes::None;
 }
 
@@ -13,19 +13,19 @@ namespace UnitJobs
 
 class Unit
 {
-    size_t      m_id                = 0;                    // index in GameState::m_Units
+    // ids are stored as 32 bit ints to keep Unit small, since every GameState holds its units inline
+    uint32_t    m_id                = 0;                    // index in GameState::m_Units
     int         m_builderID         = -1;                   // id of the unit that built this Unit, -1 if none
+    uint32_t    m_addonID           = 0;                    // id of the addon unit for this unit
+    uint32_t    m_buildID           = 0;                    // id of the Unit currently being built by this Unit
     ActionType  m_type              = ActionTypes::None;    // type of this Unit
     ActionType  m_addon             = ActionTypes::None;    // type of completed addon this Unit has
-    size_t      m_addonID           = 0;                    // id of the addon unit for this unit
     ActionType  m_buildType         = ActionTypes::None;    // type of the Unit currently being built by this Unit
-    size_t      m_buildID           = 0;                    // id of the Unit currently being built by this Unit
     int         m_job               = UnitJobs::None;       // current job this Unit has (UnitJobs::XXX)
     int         m_timeUntilBuilt    = 0;                    // time remaining until this Unit is completed
     int         m_timeUntilFree     = 0;                    // time remaining until this Unit can build again
     int         m_numLarva          = 0;                    // number of larva this building currently has (Hatch only)
     int         m_timeUntilLarva    = 0;
-    std::vector<int> m_larvaToAdd;
 
 public:
 
@@ -43,7 +43,7 @@ public:
     bool hasAddon() const;
     int timeUntilLarva() const;
     int numLarva() const;
-    std::vector<int>& larvaToAdd();
+    bool isIdle() const;
 
 
     int whenCanBuild(const ActionType & type) const;
@@ -52,7 +52,7 @@ public:
     void setBuilderID(const int id);
     void startBuilding(const Unit & Unit);
     void startMorphing(const ActionType& type);
-    void fastForward(const int frames);
+    int  fastForward(const int frames, int larvaToAdd[3]);
     void useLarva();
     void addLarva();
 
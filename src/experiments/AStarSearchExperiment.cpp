@@ -13,11 +13,14 @@ AStarSearchExperiment::AStarSearchExperiment()
     : m_searchTimeLimitMS(30000)
     , m_printNewBest(false)
     , m_smartSearch(true)
+    , m_storeNodeStates(true)
+    , m_useBucketQueue(false)
     , m_orderings({ ActionOrderingType::None })
     , m_useRepetitions(true)
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
@@ -27,13 +30,18 @@ AStarSearchExperiment::AStarSearchExperiment()
 AStarSearchExperiment::AStarSearchExperiment(const std::string & name, const json & val)
     : m_name(name)
     , m_searchTimeLimitMS(30000)
+    , m_memoryLimitMB(0)
+    , m_numThreads(1)
     , m_printNewBest(false)
     , m_smartSearch(true)
+    , m_storeNodeStates(true)
+    , m_useBucketQueue(false)
     , m_orderings({ ActionOrderingType::None })
     , m_useRepetitions(true)
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
@@ -47,6 +55,11 @@ AStarSearchExperiment::AStarSearchExperiment(const std::string & name, const jso
     BOSS_ASSERT(val.count("SearchTimeLimitMS") && val["SearchTimeLimitMS"].is_number_integer(), "AStarSearchExperiment must have a 'SearchTimeLimitMS' int");
     m_searchTimeLimitMS = val["SearchTimeLimitMS"];
 
+    if (val.count("MemoryLimitMB") && val["MemoryLimitMB"].is_number_integer())
+    {
+        m_memoryLimitMB = val["MemoryLimitMB"];
+    }
+
     if (val.count("SmartSearch") && val["SmartSearch"].is_boolean())
     {
         m_smartSearch = val["SmartSearch"];
@@ -89,10 +102,13 @@ AStarSearchExperiment::AStarSearchExperiment(const std::string & name, const jso
         }
     }
 
+    JSONTools::ReadBool("StoreNodeStates",          val, m_storeNodeStates);
+    JSONTools::ReadBool("UseBucketQueue",           val, m_useBucketQueue);
     JSONTools::ReadBool("UseRepetitions",           val, m_useRepetitions);
     JSONTools::ReadBool("UseIncreasingRepetitions", val, m_useIncreasingRepetitions);
     JSONTools::ReadBool("UseLandmarkLowerBound",    val, m_useLandmarkLowerBound);
     JSONTools::ReadBool("UseResourceLowerBound",    val, m_useResourceLowerBound);
+    JSONTools::ReadBool("UseBuilderLowerBound",     val, m_useBuilderLowerBound);
     JSONTools::ReadBool("UseAlwaysMakeWorkers",     val, m_useAlwaysMakeWorkers);
     JSONTools::ReadBool("UseSupplyBounding",        val, m_useSupplyBounding);
 
@@ -100,6 +116,8 @@ AStarSearchExperiment::AStarSearchExperiment(const std::string & name, const jso
     {
         m_supplyBoundingThreshold = val["SupplyBoundingThreshold"];
     }
+
+    JSONTools::ReadThreads("Threads", val, m_numThreads);
 }
 
 void AStarSearchExperiment::printResults(const DFBB_BuildOrderSearchResults & results) const
@@ -110,6 +128,7 @@ void AStarSearchExperiment::printResults(const DFBB_BuildOrderSearchResults & re
     std::cout << "  Upper Bound:    " << results.upperBound << " frames\n";
     std::cout << "  Nodes Expanded: " << results.nodesExpanded << "\n";
     std::cout << "  Time Elapsed:   " << results.timeElapsed << " ms\n";
+    std::cout << "  Threads:        " << m_numThreads << "\n";
 
     if (results.nodesExpanded > 0 && results.timeElapsed > 0)
     {
@@ -145,14 +164,19 @@ void AStarSearchExperiment::run()
         search.setState(m_initialState);
         search.setGoal(m_goal);
         search.setTimeLimit(m_searchTimeLimitMS);
+        search.setMemoryLimitMB(m_memoryLimitMB);
+        search.setNumThreads(m_numThreads);
         search.setPrintNewBest(m_printNewBest);
         search.setSmartSearch(m_smartSearch);
+        search.setStoreNodeStates(m_storeNodeStates);
+        search.setUseBucketQueue(m_useBucketQueue);
         search.setOrdering(ordering);
         search.setRelevantActions(m_relevantActions);
         search.setUseRepetitions(m_useRepetitions);
         search.setUseIncreasingRepetitions(m_useIncreasingRepetitions);
         search.setUseLandmarkLowerBound(m_useLandmarkLowerBound);
         search.setUseResourceLowerBound(m_useResourceLowerBound);
+        search.setUseBuilderLowerBound(m_useBuilderLowerBound);
         search.setUseAlwaysMakeWorkers(m_useAlwaysMakeWorkers);
         search.setUseSupplyBounding(m_useSupplyBounding);
         search.setSupplyBoundingThreshold(m_supplyBoundingThreshold);
@@ -25,13 +25,18 @@ class AStarSearchExperiment
     GameState               m_initialState;
     BuildOrderSearchGoal    m_goal;
     int                     m_searchTimeLimitMS;
+    int                     m_memoryLimitMB;
+    size_t                  m_numThreads;
     bool                    m_printNewBest;
     bool                    m_smartSearch;
+    bool                    m_storeNodeStates;
+    bool                    m_useBucketQueue;
     std::vector<ActionOrderingType> m_orderings;
     bool                    m_useRepetitions;
     bool                    m_useIncreasingRepetitions;
     bool                    m_useLandmarkLowerBound;
     bool                    m_useResourceLowerBound;
+    bool                    m_useBuilderLowerBound;
     bool                    m_useAlwaysMakeWorkers;
     bool                    m_useSupplyBounding;
     double                  m_supplyBoundingThreshold;
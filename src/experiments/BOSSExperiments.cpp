@@ -6,6 +6,7 @@
 #include "DFBB_BuildOrderSmartSearch.h"
 #include "BuildOrderPlotter.h"
 #include "FileTools.h"
+#include "HeuristicTable.h"
 #include "MonteCarloTreeSearchExperiment.h"
 
 using namespace BOSS;
@@ -54,6 +55,10 @@ void Experiments::RunExperiments(const std::string & experimentFilename)
             {
                 RunAStarSearchExperiment(name, val);
             }
+            else if (type == "HeuristicTable")
+            {
+                RunHeuristicTableExperiment(name, val);
+            }
             else
             {
                 BOSS_ASSERT(false, "Unknown Experiment Type: %s", type.c_str());
@@ -144,6 +149,45 @@ void Experiments::RunAStarSearchExperiment(const std::string & name, const json
     std::cout << "    " << name << " completed" << std::endl;
 }
 
+void Experiments::RunHeuristicTableExperiment(const std::string & name, const json & val)
+{
+    std::cout << "Heuristic Table Experiment - " << name << std::endl;
+
+    BOSS_ASSERT(val.count("OutputFile") && val["OutputFile"].is_string(), "HeuristicTable experiment must have an 'OutputFile' string");
+    BOSS_ASSERT(val.count("SearchTimeLimitMS") && val["SearchTimeLimitMS"].is_number_integer(), "HeuristicTable experiment must have a 'SearchTimeLimitMS' int");
+    BOSS_ASSERT(val.count("Tables") && val["Tables"].is_array(), "HeuristicTable experiment must have a 'Tables' array");
+
+    // tables loaded at startup would feed into the searches that build the new ones
+    HeuristicTables::Clear();
+
+    for (const auto & tableVal : val["Tables"])
+    {
+        BOSS_ASSERT(tableVal.count("State") && tableVal["State"].is_string(), "HeuristicTable table must have a 'State' string");
+        BOSS_ASSERT(tableVal.count("KeyTypes") && tableVal["KeyTypes"].is_array(), "HeuristicTable table must have a 'KeyTypes' array");
+
+        std::vector<std::pair<ActionType, size_t>> keyTypes;
+        for (const auto & keyVal : tableVal["KeyTypes"])
+        {
+            BOSS_ASSERT(keyVal.is_array() && keyVal.size() == 2 && keyVal[0].is_string() && keyVal[1].is_number_integer(), "KeyTypes element must be an array of [action type string, max count]");
+            const std::string typeName = keyVal[0].get<std::string>();
+            BOSS_ASSERT(ActionTypes::TypeExists(typeName), "Action type doesn't exist: %s", typeName.c_str());
+            keyTypes.push_back({ ActionTypes::GetActionType(typeName), keyVal[1].get<size_t>() });
+        }
+
+        Timer timer;
+        timer.start();
+
+        const HeuristicTable table = HeuristicTables::Build(BOSSConfig::Instance().GetState(tableVal["State"]), keyTypes, val["SearchTimeLimitMS"]);
+        HeuristicTables::Add(table);
+
+        std::cout << "    " << tableVal["State"].get<std::string>() << ": " << table.size() << " goals in " << timer.getElapsedTimeInMilliSec() << "ms" << std::endl;
+    }
+
+    HeuristicTables::Save(val["OutputFile"]);
+
+    std::cout << "    " << name << " completed" << std::endl;
+}
+
 void Experiments::RunBuildOrderPlot(const std::string & name, const json & j)
 {
     std::cout << "Build Order Plot Experiment - " << name << std::endl;
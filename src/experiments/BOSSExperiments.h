@@ -16,6 +16,7 @@ namespace Experiments
     void RunBuildOrderSearchExperiment(const std::string & name, const json & val);
     void RunMonteCarloTreeSearchExperiment(const std::string & name, const json & val);
     void RunAStarSearchExperiment(const std::string & name, const json & val);
+    void RunHeuristicTableExperiment(const std::string & name, const json & val);
 }
 
 }
@@ -17,9 +17,12 @@ DFBBSearchExperiment::DFBBSearchExperiment()
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
+    , m_useTranspositionTable(false)
+    , m_numThreads(1)
 {
 }
 
@@ -33,9 +36,12 @@ DFBBSearchExperiment::DFBBSearchExperiment(const std::string & name, const json
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
+    , m_useTranspositionTable(false)
+    , m_numThreads(1)
 {
     BOSS_ASSERT(val.count("State") && val["State"].is_string(), "DFBBSearchExperiment must have a 'State' string");
     m_initialState = BOSSConfig::Instance().GetState(val["State"]);
@@ -92,13 +98,17 @@ DFBBSearchExperiment::DFBBSearchExperiment(const std::string & name, const json
     JSONTools::ReadBool("UseIncreasingRepetitions", val, m_useIncreasingRepetitions);
     JSONTools::ReadBool("UseLandmarkLowerBound",    val, m_useLandmarkLowerBound);
     JSONTools::ReadBool("UseResourceLowerBound",    val, m_useResourceLowerBound);
+    JSONTools::ReadBool("UseBuilderLowerBound",     val, m_useBuilderLowerBound);
     JSONTools::ReadBool("UseAlwaysMakeWorkers",     val, m_useAlwaysMakeWorkers);
     JSONTools::ReadBool("UseSupplyBounding",        val, m_useSupplyBounding);
+    JSONTools::ReadBool("UseTranspositionTable",    val, m_useTranspositionTable);
 
     if (val.count("SupplyBoundingThreshold") && val["SupplyBoundingThreshold"].is_number())
     {
         m_supplyBoundingThreshold = val["SupplyBoundingThreshold"];
     }
+
+    JSONTools::ReadThreads("Threads", val, m_numThreads);
 }
 
 void DFBBSearchExperiment::printResults(const DFBB_BuildOrderSearchResults & results) const
@@ -109,12 +119,20 @@ void DFBBSearchExperiment::printResults(const DFBB_BuildOrderSearchResults & res
     std::cout << "  Upper Bound:    " << results.upperBound << " frames\n";
     std::cout << "  Nodes Expanded: " << results.nodesExpanded << "\n";
     std::cout << "  Time Elapsed:   " << results.timeElapsed << " ms\n";
+    std::cout << "  Threads:        " << m_numThreads << "\n";
 
     if (results.nodesExpanded > 0 && results.timeElapsed > 0)
     {
         std::cout << "  Nodes/sec:      " << (1000.0 * results.nodesExpanded / results.timeElapsed) << "\n";
     }
 
+    if (m_useTranspositionTable)
+    {
+        std::cout << "  TT Hits:        " << results.transpositionHits << "\n";
+        std::cout << "  TT Misses:      " << results.transpositionMisses << "\n";
+        std::cout << "  TT Prunes:      " << results.transpositionPrunes << "\n";
+    }
+
     if (results.buildOrder.size() > 0)
     {
         std::cout << "\n  Build Order (" << results.buildOrder.size() << " actions):\n    ";
@@ -155,9 +173,12 @@ void DFBBSearchExperiment::run()
             search.setUseIncreasingRepetitions(m_useIncreasingRepetitions);
             search.setUseLandmarkLowerBound(m_useLandmarkLowerBound);
             search.setUseResourceLowerBound(m_useResourceLowerBound);
+            search.setUseBuilderLowerBound(m_useBuilderLowerBound);
             search.setUseAlwaysMakeWorkers(m_useAlwaysMakeWorkers);
             search.setUseSupplyBounding(m_useSupplyBounding);
             search.setSupplyBoundingThreshold(m_supplyBoundingThreshold);
+            search.setUseTranspositionTable(m_useTranspositionTable);
+            search.setNumThreads(m_numThreads);
             search.search();
             run.results = search.getResults();
         }
@@ -174,9 +195,12 @@ void DFBBSearchExperiment::run()
             params.m_useIncreasingRepetitions         = m_useIncreasingRepetitions;
             params.m_useLandmarkLowerBoundHeuristic   = m_useLandmarkLowerBound;
             params.m_useResourceLowerBoundHeuristic   = m_useResourceLowerBound;
+            params.m_useBuilderLowerBoundHeuristic    = m_useBuilderLowerBound;
             params.m_useAlwaysMakeWorkers             = m_useAlwaysMakeWorkers;
             params.m_useSupplyBounding                = m_useSupplyBounding;
             params.m_supplyBoundingThreshold          = m_supplyBoundingThreshold;
+            params.m_useTranspositionTable            = m_useTranspositionTable;
+            params.m_numThreads                       = m_numThreads;
 
             DFBB_BuildOrderStackSearch search(params);
             search.search();
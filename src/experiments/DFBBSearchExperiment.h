@@ -33,9 +33,12 @@ class DFBBSearchExperiment
     bool                    m_useIncreasingRepetitions;
     bool                    m_useLandmarkLowerBound;
     bool                    m_useResourceLowerBound;
+    bool                    m_useBuilderLowerBound;
     bool                    m_useAlwaysMakeWorkers;
     bool                    m_useSupplyBounding;
     double                  m_supplyBoundingThreshold;
+    bool                    m_useTranspositionTable;
+    size_t                  m_numThreads;
     std::vector<ActionType> m_relevantActions;
 
     void printResults(const DFBB_BuildOrderSearchResults & results) const;
@@ -17,9 +17,14 @@ MonteCarloTreeSearchExperiment::MonteCarloTreeSearchExperiment()
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
+    , m_numThreads(1)
+    , m_useTreeParallelism(false)
+    , m_rolloutPolicy(RolloutPolicyType::Naive)
+    , m_useTranspositions(false)
 {
 }
 
@@ -33,9 +38,14 @@ MonteCarloTreeSearchExperiment::MonteCarloTreeSearchExperiment(const std::string
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
+    , m_numThreads(1)
+    , m_useTreeParallelism(false)
+    , m_rolloutPolicy(RolloutPolicyType::Naive)
+    , m_useTranspositions(false)
 {
     BOSS_ASSERT(val.count("State") && val["State"].is_string(), "MonteCarloTreeSearchExperiment must have a 'State' string");
     m_initialState = BOSSConfig::Instance().GetState(val["State"]);
@@ -73,13 +83,23 @@ MonteCarloTreeSearchExperiment::MonteCarloTreeSearchExperiment(const std::string
     JSONTools::ReadBool("UseIncreasingRepetitions",  val, m_useIncreasingRepetitions);
     JSONTools::ReadBool("UseLandmarkLowerBound",     val, m_useLandmarkLowerBound);
     JSONTools::ReadBool("UseResourceLowerBound",     val, m_useResourceLowerBound);
+    JSONTools::ReadBool("UseBuilderLowerBound",      val, m_useBuilderLowerBound);
     JSONTools::ReadBool("UseAlwaysMakeWorkers",      val, m_useAlwaysMakeWorkers);
     JSONTools::ReadBool("UseSupplyBounding",         val, m_useSupplyBounding);
+    JSONTools::ReadBool("UseTreeParallelism",        val, m_useTreeParallelism);
+    JSONTools::ReadBool("UseTranspositions",         val, m_useTranspositions);
 
     if (val.count("SupplyBoundingThreshold") && val["SupplyBoundingThreshold"].is_number())
     {
         m_supplyBoundingThreshold = val["SupplyBoundingThreshold"];
     }
+
+    if (val.count("RolloutPolicy") && val["RolloutPolicy"].is_string())
+    {
+        m_rolloutPolicy = RolloutPolicy::GetPolicyType(val["RolloutPolicy"].get<std::string>());
+    }
+
+    JSONTools::ReadThreads("Threads", val, m_numThreads);
 }
 
 void MonteCarloTreeSearchExperiment::run()
@@ -98,9 +118,14 @@ void MonteCarloTreeSearchExperiment::run()
     search.setUseIncreasingRepetitions(m_useIncreasingRepetitions);
     search.setUseLandmarkLowerBound(m_useLandmarkLowerBound);
     search.setUseResourceLowerBound(m_useResourceLowerBound);
+    search.setUseBuilderLowerBound(m_useBuilderLowerBound);
     search.setUseAlwaysMakeWorkers(m_useAlwaysMakeWorkers);
     search.setUseSupplyBounding(m_useSupplyBounding);
     search.setSupplyBoundingThreshold(m_supplyBoundingThreshold);
+    search.setNumThreads(m_numThreads);
+    search.setUseTreeParallelism(m_useTreeParallelism);
+    search.setRolloutPolicy(m_rolloutPolicy);
+    search.setUseTranspositions(m_useTranspositions);
     search.search();
 
     const DFBB_BuildOrderSearchResults & results = search.getResults();
@@ -125,6 +150,8 @@ void MonteCarloTreeSearchExperiment::printResults(const DFBB_BuildOrderSearchRes
     std::cout << "  Upper Bound:    " << results.upperBound << " frames\n";
     std::cout << "  Nodes Expanded: " << results.nodesExpanded << "\n";
     std::cout << "  Time Elapsed:   " << results.timeElapsed << " ms\n";
+    std::cout << "  Threads:        " << m_numThreads << (m_useTreeParallelism ? " (tree parallel)" : "") << "\n";
+    std::cout << "  Rollout Policy: " << RolloutPolicy::GetPolicyName(m_rolloutPolicy) << "\n";
 
     if (results.nodesExpanded > 0 && results.timeElapsed > 0)
     {
@@ -5,6 +5,7 @@
 #include "DFBB_BuildOrderSearchResults.h"
 #include "GameState.h"
 #include "JSONTools.h"
+#include "RolloutPolicy.hpp"
 
 namespace BOSS
 {
@@ -30,9 +31,14 @@ class MonteCarloTreeSearchExperiment
     bool                    m_useIncreasingRepetitions;
     bool                    m_useLandmarkLowerBound;
     bool                    m_useResourceLowerBound;
+    bool                    m_useBuilderLowerBound;
     bool                    m_useAlwaysMakeWorkers;
     bool                    m_useSupplyBounding;
     double                  m_supplyBoundingThreshold;
+    size_t                  m_numThreads;
+    bool                    m_useTreeParallelism;
+    RolloutPolicyType       m_rolloutPolicy;
+    bool                    m_useTranspositions;
 
     void printResults(const DFBB_BuildOrderSearchResults & results) const;
     void writeResultsFile(const DFBB_BuildOrderSearchResults & results) const;
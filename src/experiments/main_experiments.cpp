@@ -6,7 +6,7 @@ using namespace BOSS;
 int main(int argc, char *argv[])
 {
     // Initialize all the BOSS internal data
-    BOSS::Init("config/BWData.json");
+    BOSS::Init("config/BWData.json", "config/BOSS_HeuristicTables.bin");
 
     // Read in the config parameters that will be used for experiments
     BOSS::BOSSConfig::Instance().ParseConfig("config/BOSS_Config.txt");
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <thread>
 
 using namespace BOSS;
 
@@ -24,32 +25,45 @@ bool AStarBuildOrderSearch::QueueEntryCompare::operator()(const QueueEntry & lhs
 }
 
 AStarBuildOrderSearch::AStarBuildOrderSearch()
-    : m_searchTimeLimitMS(30000)
+    : m_deadline(std::make_shared<Deadline>())
+    , m_searchTimeLimitMS(30000)
+    , m_memoryLimitMB(0)
     , m_printNewBest(false)
     , m_smartSearch(true)
+    , m_storeNodeStates(true)
+    , m_useBucketQueue(false)
     , m_ordering(ActionOrderingType::None)
     , m_useRepetitions(true)
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
     , m_sequence(0)
+    , m_numThreads(1)
+    , m_threadIndex(0)
+    , m_parallelData(nullptr)
 {
 }
 
 void AStarBuildOrderSearch::setGoal(const BuildOrderSearchGoal & goal)                         { m_goal = goal; }
 void AStarBuildOrderSearch::setState(const GameState & state)                                 { m_initialState = state; }
 void AStarBuildOrderSearch::setTimeLimit(int ms)                                              { m_searchTimeLimitMS = ms; }
+void AStarBuildOrderSearch::setMemoryLimitMB(int mb)                                          { m_memoryLimitMB = mb; }
+void AStarBuildOrderSearch::setNumThreads(size_t numThreads)                                  { m_numThreads = std::max(numThreads, (size_t)1); }
 void AStarBuildOrderSearch::setPrintNewBest(bool printNewBest)                                { m_printNewBest = printNewBest; }
 void AStarBuildOrderSearch::setSmartSearch(bool smartSearch)                                  { m_smartSearch = smartSearch; }
+void AStarBuildOrderSearch::setStoreNodeStates(bool storeNodeStates)                          { m_storeNodeStates = storeNodeStates; }
+void AStarBuildOrderSearch::setUseBucketQueue(bool useBucketQueue)                            { m_useBucketQueue = useBucketQueue; }
 void AStarBuildOrderSearch::setOrdering(ActionOrderingType ordering)                          { m_ordering = ordering; }
 void AStarBuildOrderSearch::setRelevantActions(const std::vector<ActionType> & relevantActions){ m_relevantActions = relevantActions; }
 void AStarBuildOrderSearch::setUseRepetitions(bool val)                                       { m_useRepetitions = val; }
 void AStarBuildOrderSearch::setUseIncreasingRepetitions(bool val)                             { m_useIncreasingRepetitions = val; }
 void AStarBuildOrderSearch::setUseLandmarkLowerBound(bool val)                                { m_useLandmarkLowerBound = val; }
 void AStarBuildOrderSearch::setUseResourceLowerBound(bool val)                                { m_useResourceLowerBound = val; }
+void AStarBuildOrderSearch::setUseBuilderLowerBound(bool val)                                 { m_useBuilderLowerBound = val; }
 void AStarBuildOrderSearch::setUseAlwaysMakeWorkers(bool val)                                 { m_useAlwaysMakeWorkers = val; }
 void AStarBuildOrderSearch::setUseSupplyBounding(bool val)                                    { m_useSupplyBounding = val; }
 void AStarBuildOrderSearch::setSupplyBoundingThreshold(double val)                            { m_supplyBoundingThreshold = val; }
@@ -61,108 +75,287 @@ void AStarBuildOrderSearch::search()
 
     m_results = DFBB_BuildOrderSearchResults();
     m_nodes.clear();
+    m_nodeStates.clear();
+    m_freeStateSlots.clear();
     m_bestStateFinish.clear();
-    m_openQueue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, QueueEntryCompare>();
+    m_openQueue.setUseBuckets(m_useBucketQueue);
     m_sequence = 0;
 
     m_searchTimer.start();
+    m_deadline->start(m_searchTimeLimitMS);
     initializeParameters();
     initializeActionOrdering();
     initializeIncumbent();
 
     if (m_params.m_goal.isAchievedBy(m_initialState))
     {
-        updateBestSolution(m_initialState, BuildOrder());
+        updateBestSolution(m_initialState, NoNode);
         m_results.solved = true;
         m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+        m_deadline->stop();
         return;
     }
 
-    pushNode(m_initialState, BuildOrder());
+    if (m_numThreads > 1)
+    {
+        searchParallel();
+    }
+    else
+    {
+        pushNode(m_initialState, 0, NoNode, ActionTypes::None, 0);
+
+        while (!m_openQueue.empty())
+        {
+            if (isTimeOut())
+            {
+                m_results.timedOut = true;
+                break;
+            }
+
+            // out of memory: throw away the open list and carry on depth first, starting from the best open lower bound
+            if (m_memoryLimitMB > 0 && getMemoryUsage() > static_cast<size_t>(m_memoryLimitMB) * 1024 * 1024)
+            {
+                const int threshold = m_openQueue.top().priority;
+
+                m_nodes = std::vector<SearchNode>();
+                m_nodeStates = std::vector<GameState>();
+                m_freeStateSlots = std::vector<size_t>();
+                m_bestStateFinish = std::unordered_map<uint64_t, int>();
+                m_openQueue.clear();
+
+                searchIterativeDeepening(threshold);
+                break;
+            }
+
+            const QueueEntry entry = m_openQueue.top();
+            m_openQueue.pop();
 
-    while (!m_openQueue.empty())
+            if (entry.priority >= getUpperBound())
+            {
+                break;
+            }
+
+            GameState state;
+            getNodeState(entry.nodeIndex, state);
+            expandNode(entry.nodeIndex, state);
+        }
+    }
+
+    m_deadline->stop();
+    m_results.solved = !m_results.timedOut;
+    m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+}
+
+// generates the children of an open node, recording solutions and adding the rest to the open list
+void AStarBuildOrderSearch::expandNode(const size_t nodeIndex, const GameState & state)
+{
+    if (m_params.m_goal.isAchievedBy(state))
     {
-        if (isTimeOut())
+        updateBestSolution(state, nodeIndex);
+        return;
+    }
+
+    m_results.nodesExpanded++;
+
+    ActionSet legalActions;
+    generateLegalActions(state, legalActions);
+    applyOrdering(state, legalActions);
+    const int heuristicTime = getHeuristicTime(state);
+
+    for (size_t a(0); a < legalActions.size(); ++a)
+    {
+        const ActionType & actionType = legalActions[a];
+
+        if (shouldPruneAction(state, actionType, heuristicTime))
         {
-            m_results.timedOut = true;
-            break;
+            continue;
         }
 
-        const QueueEntry entry = m_openQueue.top();
-        m_openQueue.pop();
+        GameState childState(state);
+        const size_t repetitions = getRepetitions(childState, actionType);
+        BOSS_ASSERT(repetitions > 0, "Can't have zero repetitions!");
 
-        if (m_results.solutionFound && entry.priority >= m_results.upperBound)
+        size_t completedRepetitions = 0;
+        for (; completedRepetitions < repetitions; ++completedRepetitions)
         {
-            break;
+            if (!childState.isLegal(actionType))
+            {
+                break;
+            }
+
+            childState.doAction(actionType);
         }
 
-        const GameState state = m_nodes[entry.nodeIndex].state;
-        const BuildOrder buildOrder = m_nodes[entry.nodeIndex].buildOrder;
+        if (completedRepetitions == 0)
+        {
+            continue;
+        }
 
-        if (m_params.m_goal.isAchievedBy(state))
+        const int childLowerBound = estimateLowerBound(childState);
+        if (childLowerBound >= getUpperBound())
         {
-            updateBestSolution(state, buildOrder);
             continue;
         }
 
-        m_results.nodesExpanded++;
+        if (m_params.m_goal.isAchievedBy(childState))
+        {
+            updateBestSolution(childState, nodeIndex, actionType, completedRepetitions);
+            continue;
+        }
 
-        ActionSet legalActions;
-        generateLegalActions(state, legalActions);
-        applyOrdering(state, legalActions);
+        addChild(childState, nodeIndex, actionType, completedRepetitions);
+    }
+}
 
-        for (size_t a(0); a < legalActions.size(); ++a)
+// adds a child of one of this thread's nodes to the open list, or in a parallel search sends it to the thread which owns its hash
+void AStarBuildOrderSearch::addChild(const GameState & state, const size_t parent, const ActionType & action, const size_t repetitions)
+{
+    if (!m_parallelData)
+    {
+        if (shouldRememberState(state))
         {
-            const ActionType & actionType = legalActions[a];
+            pushNode(state, m_threadIndex, parent, action, repetitions);
+        }
 
-            if (shouldPruneAction(state, actionType))
-            {
-                continue;
-            }
+        return;
+    }
+
+    const size_t owner = getStateKey(state) % m_numThreads;
+    if (owner == m_threadIndex)
+    {
+        if (shouldRememberState(state))
+        {
+            m_parallelData->openNodes++;
+            pushNode(state, m_threadIndex, parent, action, repetitions);
+        }
 
-            GameState childState(state);
-            BuildOrder childBuildOrder(buildOrder);
-            const size_t repetitions = getRepetitions(childState, actionType);
-            BOSS_ASSERT(repetitions > 0, "Can't have zero repetitions!");
+        return;
+    }
 
-            size_t completedRepetitions = 0;
-            for (; completedRepetitions < repetitions; ++completedRepetitions)
-            {
-                if (!childState.isLegal(actionType))
-                {
-                    break;
-                }
+    m_parallelData->openNodes++;
+    std::lock_guard<std::mutex> lock(m_parallelData->inboxMutexes[owner]);
+    m_parallelData->inboxes[owner].push_back(AStarChildMessage{ state, static_cast<uint32_t>(m_threadIndex), parent, action, static_cast<uint32_t>(repetitions) });
+}
 
-                childBuildOrder.add(actionType);
-                childState.doAction(actionType);
-            }
+// the finish time a new solution has to beat, shared by every thread of a parallel search
+int AStarBuildOrderSearch::getUpperBound() const
+{
+    if (m_parallelData)
+    {
+        return m_parallelData->upperBound.load(std::memory_order_relaxed);
+    }
 
-            if (completedRepetitions == 0)
-            {
-                continue;
-            }
+    return m_results.solutionFound ? m_results.upperBound : std::numeric_limits<int>::max();
+}
 
-            const int childLowerBound = estimateLowerBound(childState);
-            if (m_results.solutionFound && childLowerBound >= m_results.upperBound)
-            {
-                continue;
-            }
+// hash distributed A*: every state is owned by one thread, chosen by its hash, which keeps its own open list
+// and closed map, so duplicates are still detected without any shared tables
+void AStarBuildOrderSearch::searchParallel()
+{
+    AStarParallelSearchData shared(m_numThreads);
+    shared.upperBound = getUpperBound();
+    shared.results = m_results;
 
-            if (m_params.m_goal.isAchievedBy(childState))
-            {
-                updateBestSolution(childState, childBuildOrder);
-                continue;
-            }
+    std::vector<std::unique_ptr<AStarBuildOrderSearch>> threads;
+    for (size_t t(0); t < m_numThreads; ++t)
+    {
+        threads.push_back(std::make_unique<AStarBuildOrderSearch>(*this));
+        threads[t]->m_threadIndex = t;
+        threads[t]->m_parallelData = &shared;
+        shared.threads.push_back(threads[t].get());
+    }
+
+    const size_t rootOwner = getStateKey(m_initialState) % m_numThreads;
+    shared.openNodes = 1;
+    threads[rootOwner]->pushNode(m_initialState, 0, NoNode, ActionTypes::None, 0);
+
+    std::vector<std::thread> runningThreads;
+    for (size_t t(0); t < m_numThreads; ++t)
+    {
+        runningThreads.emplace_back(&AStarBuildOrderSearch::searchThread, threads[t].get());
+    }
+
+    for (std::thread & thread : runningThreads)
+    {
+        thread.join();
+    }
+
+    const unsigned long long nodesExpanded = m_results.nodesExpanded;
+    m_results = shared.results;
+    m_results.nodesExpanded = nodesExpanded;
+    m_results.timedOut = false;
+    for (const auto & thread : threads)
+    {
+        m_results.nodesExpanded += thread->m_results.nodesExpanded;
+        m_results.timedOut |= thread->m_results.timedOut;
+    }
+}
+
+// the loop run by each thread of a parallel search
+void AStarBuildOrderSearch::searchThread()
+{
+    while (true)
+    {
+        if (isTimeOut())
+        {
+            m_results.timedOut = true;
+            break;
+        }
 
-            if (shouldRememberState(childState))
+        receiveChildren();
+
+        if (m_openQueue.empty())
+        {
+            // nothing is left anywhere, so every node which could beat the incumbent has been expanded
+            if (m_parallelData->openNodes == 0)
             {
-                pushNode(childState, childBuildOrder);
+                break;
             }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        const QueueEntry entry = m_openQueue.top();
+        m_openQueue.pop();
+
+        // the rest of this open list can't beat the incumbent either
+        if (entry.priority >= getUpperBound())
+        {
+            m_parallelData->openNodes -= static_cast<long long>(m_openQueue.size()) + 1;
+            m_openQueue.clear();
+            continue;
         }
+
+        GameState state;
+        getNodeState(entry.nodeIndex, state);
+        expandNode(entry.nodeIndex, state);
+
+        // children were counted when they were added, so this can't let the count reach 0 early
+        m_parallelData->openNodes--;
     }
+}
 
-    m_results.solved = !m_results.timedOut;
-    m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+// moves the children other threads have sent to this one into its open list
+void AStarBuildOrderSearch::receiveChildren()
+{
+    std::vector<AStarChildMessage> messages;
+    {
+        std::lock_guard<std::mutex> lock(m_parallelData->inboxMutexes[m_threadIndex]);
+        messages.swap(m_parallelData->inboxes[m_threadIndex]);
+    }
+
+    for (const AStarChildMessage & message : messages)
+    {
+        if (shouldRememberState(message.state))
+        {
+            pushNode(message.state, message.parentThread, message.parent, message.action, message.repetitions);
+        }
+        else
+        {
+            m_parallelData->openNodes--;
+        }
+    }
 }
 
 void AStarBuildOrderSearch::initializeParameters()
@@ -180,6 +373,9 @@ void AStarBuildOrderSearch::initializeParameters()
     m_params.m_useIncreasingRepetitions = m_useIncreasingRepetitions;
     m_params.m_useLandmarkLowerBoundHeuristic = m_useLandmarkLowerBound;
     m_params.m_useResourceLowerBoundHeuristic = m_useResourceLowerBound;
+    m_params.m_useBuilderLowerBoundHeuristic = m_useBuilderLowerBound;
+    m_lowerBound = LowerBoundEvaluator(m_goal, m_useLandmarkLowerBound, m_useResourceLowerBound, m_useBuilderLowerBound);
+    m_lowerBound.setRootState(m_initialState);
     m_params.m_useAlwaysMakeWorkers = m_useAlwaysMakeWorkers;
     m_params.m_useSupplyBounding = m_useSupplyBounding;
     m_params.m_supplyBoundingThreshold = m_supplyBoundingThreshold;
@@ -261,17 +457,96 @@ void AStarBuildOrderSearch::initializeIncumbent()
     m_results.buildOrder = naiveBuildOrder;
 }
 
-void AStarBuildOrderSearch::pushNode(const GameState & state, const BuildOrder & buildOrder)
+void AStarBuildOrderSearch::pushNode(const GameState & state, const size_t parentThread, const size_t parent, const ActionType & action, const size_t repetitions)
 {
-    const SearchNode node{ state, buildOrder, state.getLastActionFinishTime(), estimateLowerBound(state), m_sequence++ };
+    SearchNode node{ parent, NoNode, action, static_cast<uint32_t>(repetitions), static_cast<uint32_t>(parentThread) };
+
+    if (m_storeNodeStates)
+    {
+        if (m_freeStateSlots.empty())
+        {
+            node.stateIndex = m_nodeStates.size();
+            m_nodeStates.push_back(state);
+        }
+        else
+        {
+            node.stateIndex = m_freeStateSlots.back();
+            m_freeStateSlots.pop_back();
+            m_nodeStates[node.stateIndex] = state;
+        }
+    }
+
     const size_t nodeIndex = m_nodes.size();
-    m_nodes.push_back(node);
-    m_openQueue.push(QueueEntry{ nodeIndex, node.lowerBound, node.finishTime, node.sequence });
+    if (m_parallelData)
+    {
+        std::lock_guard<std::mutex> lock(m_parallelData->nodeMutexes[m_threadIndex]);
+        m_nodes.push_back(node);
+    }
+    else
+    {
+        m_nodes.push_back(node);
+    }
+
+    m_openQueue.push(QueueEntry{ nodeIndex, estimateLowerBound(state), state.getLastActionFinishTime(), m_sequence++ });
+}
+
+// gets the state of an open node, either from its stored slot (which is then freed) or by replaying its build order
+void AStarBuildOrderSearch::getNodeState(const size_t nodeIndex, GameState & state)
+{
+    const size_t stateIndex = m_nodes[nodeIndex].stateIndex;
+    if (stateIndex != NoNode)
+    {
+        state = m_nodeStates[stateIndex];
+        m_freeStateSlots.push_back(stateIndex);
+        return;
+    }
+
+    state = m_initialState;
+    const BuildOrder buildOrder = getBuildOrder(m_threadIndex, nodeIndex);
+    for (size_t i(0); i < buildOrder.size(); ++i)
+    {
+        state.doAction(buildOrder[i]);
+    }
+}
+
+// a copy of a node, which in a parallel search may belong to another thread
+AStarBuildOrderSearch::SearchNode AStarBuildOrderSearch::getNode(const size_t thread, const size_t nodeIndex) const
+{
+    if (!m_parallelData || thread == m_threadIndex)
+    {
+        return m_nodes[nodeIndex];
+    }
+
+    std::lock_guard<std::mutex> lock(m_parallelData->nodeMutexes[thread]);
+    return m_parallelData->threads[thread]->m_nodes[nodeIndex];
+}
+
+BuildOrder AStarBuildOrderSearch::getBuildOrder(const size_t thread, const size_t nodeIndex) const
+{
+    std::vector<SearchNode> path;
+    for (size_t t = thread, n = nodeIndex; n != NoNode; )
+    {
+        path.push_back(getNode(t, n));
+        t = path.back().parentThread;
+        n = path.back().parent;
+    }
+
+    BuildOrder buildOrder;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        const SearchNode & node = *it;
+        if (node.repetitions > 0)
+        {
+            buildOrder.add(node.action, static_cast<int>(node.repetitions));
+        }
+    }
+
+    return buildOrder;
 }
 
 bool AStarBuildOrderSearch::shouldRememberState(const GameState & state)
 {
-    const std::string key = getStateKey(state);
+    const uint64_t key = getStateKey(state);
     const int finishTime = state.getLastActionFinishTime();
     const auto it = m_bestStateFinish.find(key);
     if (it != m_bestStateFinish.end() && it->second <= finishTime)
@@ -283,20 +558,41 @@ bool AStarBuildOrderSearch::shouldRememberState(const GameState & state)
     return true;
 }
 
-std::string AStarBuildOrderSearch::getStateKey(const GameState & state) const
+uint64_t AStarBuildOrderSearch::getStateKey(const GameState & state) const
 {
-    return state.toStringAllUnits() + state.toStringResources();
+    return state.hash();
 }
 
 int AStarBuildOrderSearch::estimateLowerBound(const GameState & state)
 {
-    int lowerBound = state.getLastActionFinishTime();
-    if (m_params.m_useLandmarkLowerBoundHeuristic || m_params.m_useResourceLowerBoundHeuristic)
+    return std::max(state.getLastActionFinishTime(), getHeuristicTime(state));
+}
+
+// the earliest frame the goal can be finished from this state by the enabled heuristics
+int AStarBuildOrderSearch::getHeuristicTime(const GameState & state) const
+{
+    return state.getCurrentFrame() + m_lowerBound.getLowerBound(state);
+}
+
+// state is reached by doing action repetitions times to the state of node parent
+void AStarBuildOrderSearch::updateBestSolution(const GameState & state, const size_t parent, const ActionType & action, const size_t repetitions)
+{
+    const int finishTime = state.getLastActionFinishTime();
+    if (finishTime <= 0)
     {
-        lowerBound = std::max(lowerBound, state.getCurrentFrame() + Tools::GetLowerBound(state, m_params.m_goal));
+        return;
     }
 
-    return lowerBound;
+    if (finishTime < getUpperBound())
+    {
+        BuildOrder buildOrder = getBuildOrder(m_threadIndex, parent);
+        if (repetitions > 0)
+        {
+            buildOrder.add(action, static_cast<int>(repetitions));
+        }
+
+        updateBestSolution(state, buildOrder);
+    }
 }
 
 void AStarBuildOrderSearch::updateBestSolution(const GameState & state, const BuildOrder & buildOrder)
@@ -307,13 +603,26 @@ void AStarBuildOrderSearch::updateBestSolution(const GameState & state, const Bu
         return;
     }
 
-    if (!m_results.solutionFound || finishTime < m_results.upperBound)
+    std::unique_lock<std::mutex> lock;
+    DFBB_BuildOrderSearchResults & results = m_parallelData ? m_parallelData->results : m_results;
+    if (m_parallelData)
     {
-        m_results.upperBound = finishTime;
-        m_results.solutionFound = true;
-        m_results.finalState = state;
-        m_results.buildOrder = buildOrder;
-        m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+        // check again under the lock since another thread may have just found something better
+        lock = std::unique_lock<std::mutex>(m_parallelData->resultsMutex);
+    }
+
+    if (!results.solutionFound || finishTime < results.upperBound)
+    {
+        results.upperBound = finishTime;
+        results.solutionFound = true;
+        results.finalState = state;
+        results.buildOrder = buildOrder;
+        results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+
+        if (m_parallelData)
+        {
+            m_parallelData->upperBound.store(finishTime, std::memory_order_relaxed);
+        }
 
         if (m_params.m_printNewBest)
         {
@@ -322,6 +631,116 @@ void AStarBuildOrderSearch::updateBestSolution(const GameState & state, const Bu
     }
 }
 
+// rough number of bytes held by the open list, closed map and stored node states
+size_t AStarBuildOrderSearch::getMemoryUsage() const
+{
+    const size_t mapEntryBytes = sizeof(std::pair<const uint64_t, int>) + 2 * sizeof(void *);
+
+    return m_nodes.capacity()             * sizeof(SearchNode)
+         + m_nodeStates.capacity()        * sizeof(GameState)
+         + m_freeStateSlots.capacity()    * sizeof(size_t)
+         + m_openQueue.size()             * sizeof(QueueEntry)
+         + m_bestStateFinish.size()       * mapEntryBytes
+         + m_bestStateFinish.bucket_count() * sizeof(void *);
+}
+
+// IDA*: repeated depth first searches from the initial state, each one bounded by the lower bound threshold
+// uses memory proportional to the depth of the search, and keeps improving the incumbent found so far
+void AStarBuildOrderSearch::searchIterativeDeepening(int threshold)
+{
+    GameState state(m_initialState);
+    BuildOrder buildOrder;
+
+    while (threshold < getUpperBound())
+    {
+        int nextThreshold = std::numeric_limits<int>::max();
+        searchIterativeDeepeningDFS(state, buildOrder, threshold, nextThreshold);
+
+        if (m_results.timedOut)
+        {
+            break;
+        }
+
+        // every node past the threshold was pruned by the incumbent, so the search is complete
+        if (nextThreshold == std::numeric_limits<int>::max())
+        {
+            break;
+        }
+
+        threshold = nextThreshold;
+    }
+}
+
+void AStarBuildOrderSearch::searchIterativeDeepeningDFS(GameState & state, BuildOrder & buildOrder, const int threshold, int & nextThreshold)
+{
+    if (isTimeOut())
+    {
+        m_results.timedOut = true;
+        return;
+    }
+
+    m_results.nodesExpanded++;
+
+    ActionSet legalActions;
+    generateLegalActions(state, legalActions);
+    applyOrdering(state, legalActions);
+    const int heuristicTime = getHeuristicTime(state);
+
+    for (size_t a(0); a < legalActions.size() && !m_results.timedOut; ++a)
+    {
+        const ActionType & actionType = legalActions[a];
+
+        if (shouldPruneAction(state, actionType, heuristicTime))
+        {
+            continue;
+        }
+
+        const size_t repetitions = getRepetitions(state, actionType);
+        BOSS_ASSERT(repetitions > 0, "Can't have zero repetitions!");
+
+        UndoJournal journal;
+        size_t completedRepetitions = 0;
+        for (; completedRepetitions < repetitions; ++completedRepetitions)
+        {
+            if (!state.isLegal(actionType))
+            {
+                break;
+            }
+
+            buildOrder.add(actionType);
+            state.doAction(actionType, journal);
+        }
+
+        if (completedRepetitions > 0)
+        {
+            const int childLowerBound = estimateLowerBound(state);
+            if (childLowerBound >= getUpperBound())
+            {
+                // can't improve on the incumbent
+            }
+            else if (m_params.m_goal.isAchievedBy(state))
+            {
+                updateBestSolution(state, buildOrder);
+            }
+            else if (childLowerBound > threshold)
+            {
+                nextThreshold = std::min(nextThreshold, childLowerBound);
+            }
+            else
+            {
+                searchIterativeDeepeningDFS(state, buildOrder, threshold, nextThreshold);
+            }
+        }
+
+        for (size_t r(0); r < completedRepetitions; ++r)
+        {
+            buildOrder.pop_back();
+        }
+
+        state.undoAction(journal);
+    }
+}
+
 void AStarBuildOrderSearch::generateLegalActions(const GameState & state, ActionSet & legalActions)
 {
     legalActions.clear();
@@ -417,21 +836,17 @@ void AStarBuildOrderSearch::applyOrdering(const GameState & state, ActionSet & l
     }
 }
 
-bool AStarBuildOrderSearch::shouldPruneAction(const GameState & state, const ActionType & actionType)
+// heuristicTime is getHeuristicTime of the state, which is the same for all of its actions
+bool AStarBuildOrderSearch::shouldPruneAction(const GameState & state, const ActionType & actionType, const int heuristicTime)
 {
-    if (!m_results.solutionFound)
+    const int upperBound = getUpperBound();
+    if (upperBound == std::numeric_limits<int>::max())
     {
         return false;
     }
 
-    int maxHeuristic = state.whenCanBuild(actionType) + actionType.buildTime();
-    if (m_params.m_useLandmarkLowerBoundHeuristic || m_params.m_useResourceLowerBoundHeuristic)
-    {
-        const int heuristicTime = state.getCurrentFrame() + Tools::GetLowerBound(state, m_params.m_goal);
-        maxHeuristic = std::max(maxHeuristic, heuristicTime);
-    }
-
-    return maxHeuristic >= m_results.upperBound;
+    const int maxHeuristic = std::max(state.whenCanBuild(actionType) + actionType.buildTime(), heuristicTime);
+    return maxHeuristic >= upperBound;
 }
 
 size_t AStarBuildOrderSearch::getRepetitions(const GameState & state, const ActionType & actionType)
@@ -463,7 +878,7 @@ size_t AStarBuildOrderSearch::getRepetitions(const GameState & state, const Acti
 
 bool AStarBuildOrderSearch::isTimeOut()
 {
-    return m_searchTimeLimitMS > 0 && (m_results.nodesExpanded % 200 == 0) && (m_searchTimer.getElapsedTimeInMilliSec() > m_searchTimeLimitMS);
+    return m_deadline->expired();
 }
 
 void AStarBuildOrderSearch::calculateSearchSettings()
@@ -9,22 +9,64 @@
 #include "DFBB_BuildOrderSearchResults.h"
 #include "GameState.h"
 #include "Timer.hpp"
-
+#include "Deadline.hpp"
+#include "BucketQueue.hpp"
+#include "LowerBoundEvaluator.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 
 namespace BOSS
 {
 
+class AStarBuildOrderSearch;
+
+// a child generated by one thread of a parallel search, sent to the thread which owns its state hash
+struct AStarChildMessage
+{
+    GameState   state;
+    uint32_t    parentThread;
+    size_t      parent;
+    ActionType  action;
+    uint32_t    repetitions;
+};
+
+// everything the threads of a parallel (hash distributed) A* search share
+struct AStarParallelSearchData
+{
+    std::atomic<int>                        upperBound  { 0 };  // finish time a new solution has to beat
+    std::atomic<long long>                  openNodes   { 0 };  // nodes in any open list or inbox, the search is over when it reaches 0
+    std::mutex                              resultsMutex;
+    DFBB_BuildOrderSearchResults            results;            // best solution found by any thread
+    std::vector<AStarBuildOrderSearch *>    threads;
+    std::vector<std::mutex>                 nodeMutexes;        // guard each thread's m_nodes against reads of the parent chain by other threads
+    std::vector<std::mutex>                 inboxMutexes;
+    std::vector<std::vector<AStarChildMessage>> inboxes;        // children waiting to be added to each thread's open list
+
+    AStarParallelSearchData(const size_t numThreads)
+        : nodeMutexes(numThreads)
+        , inboxMutexes(numThreads)
+        , inboxes(numThreads)
+    {
+    }
+};
+
 class AStarBuildOrderSearch
 {
+    static const size_t NoNode = std::numeric_limits<size_t>::max();
+
+    // nodes only remember how they were reached, the build order and state are rebuilt from the parent chain
     struct SearchNode
     {
-        GameState   state;
-        BuildOrder  buildOrder;
-        int         finishTime;
-        int         lowerBound;
-        size_t      sequence;
+        size_t      parent;         // index in its thread's m_nodes of the node this was expanded from, NoNode for the root
+        size_t      stateIndex;     // slot in m_nodeStates holding the state while the node is open, NoNode if it is replayed
+        ActionType  action;         // action done to the parent's state to reach this node
+        uint32_t    repetitions;    // how many times the action was done
+        uint32_t    parentThread;   // thread of a parallel search which owns the parent node
     };
 
     struct QueueEntry
@@ -40,31 +82,60 @@ class AStarBuildOrderSearch
         bool operator()(const QueueEntry & lhs, const QueueEntry & rhs) const;
     };
 
+    // the open list, either a binary heap ordered by QueueEntryCompare or buckets per priority which are FIFO within a bucket
+    class OpenList
+    {
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, QueueEntryCompare> m_heap;
+        BucketQueue<QueueEntry> m_buckets;
+        bool                    m_useBuckets = false;
+
+    public:
+
+        void setUseBuckets(bool useBuckets)     { clear(); m_useBuckets = useBuckets; }
+        void push(const QueueEntry & entry)     { if (m_useBuckets) { m_buckets.push(entry); } else { m_heap.push(entry); } }
+        void pop()                              { if (m_useBuckets) { m_buckets.pop(); } else { m_heap.pop(); } }
+        const QueueEntry & top()                { return m_useBuckets ? m_buckets.top() : m_heap.top(); }
+        bool empty() const                      { return m_useBuckets ? m_buckets.empty() : m_heap.empty(); }
+        size_t size() const                     { return m_useBuckets ? m_buckets.size() : m_heap.size(); }
+        void clear()                            { m_heap = decltype(m_heap)(); m_buckets.clear(); }
+    };
+
     BuildOrderSearchGoal                m_goal;
     GameState                           m_initialState;
     DFBB_BuildOrderSearchParameters     m_params;
+    LowerBoundEvaluator                 m_lowerBound;       // the enabled lower bound heuristics for m_params.m_goal
     DFBB_BuildOrderSearchResults        m_results;
     Timer                               m_searchTimer;
+    std::shared_ptr<Deadline>           m_deadline;         // shared with the threads of a parallel search
 
     std::vector<ActionType>             m_relevantActions;
     std::vector<size_t>                 m_actionOrderRanks;
     std::vector<size_t>                 m_stateOrderRanks;
     std::vector<SearchNode>             m_nodes;
-    std::priority_queue<QueueEntry, std::vector<QueueEntry>, QueueEntryCompare> m_openQueue;
-    std::unordered_map<std::string, int> m_bestStateFinish;
+    std::vector<GameState>              m_nodeStates;       // states of the open nodes, if m_storeNodeStates is set
+    std::vector<size_t>                 m_freeStateSlots;   // slots of m_nodeStates whose node has been expanded
+    OpenList                            m_openQueue;
+    std::unordered_map<uint64_t, int>   m_bestStateFinish;
 
     int                                 m_searchTimeLimitMS;
+    int                                 m_memoryLimitMB;    // switch to iterative deepening once the open list needs more than this, 0 for no limit
     bool                                m_printNewBest;
     bool                                m_smartSearch;
+    bool                                m_storeNodeStates;  // keep open node states in memory instead of replaying their build order
+    bool                                m_useBucketQueue;   // use integer priority buckets for the open list instead of a heap
     ActionOrderingType                  m_ordering;
     bool                                m_useRepetitions;
     bool                                m_useIncreasingRepetitions;
     bool                                m_useLandmarkLowerBound;
     bool                                m_useResourceLowerBound;
+    bool                                m_useBuilderLowerBound;
     bool                                m_useAlwaysMakeWorkers;
     bool                                m_useSupplyBounding;
     double                              m_supplyBoundingThreshold;
     size_t                              m_sequence;
+    size_t                              m_numThreads;
+    size_t                              m_threadIndex;      // which thread of a parallel search this is
+    AStarParallelSearchData *           m_parallelData;
 
     void calculateSearchSettings();
     void initializeParameters();
@@ -79,14 +150,28 @@ class AStarBuildOrderSearch
     size_t calculateRefineriesRequired();
     size_t getRepetitions(const GameState & state, const ActionType & actionType);
     bool isTimeOut();
-    bool shouldPruneAction(const GameState & state, const ActionType & actionType);
+    bool shouldPruneAction(const GameState & state, const ActionType & actionType, const int heuristicTime);
     bool shouldRememberState(const GameState & state);
     int estimateLowerBound(const GameState & state);
-    std::string getStateKey(const GameState & state) const;
+    int getHeuristicTime(const GameState & state) const;
+    uint64_t getStateKey(const GameState & state) const;
     void generateLegalActions(const GameState & state, ActionSet & legalActions);
     void applyOrdering(const GameState & state, ActionSet & legalActions);
-    void pushNode(const GameState & state, const BuildOrder & buildOrder);
+    void expandNode(const size_t nodeIndex, const GameState & state);
+    void addChild(const GameState & state, const size_t parent, const ActionType & action, const size_t repetitions);
+    void pushNode(const GameState & state, const size_t parentThread, const size_t parent, const ActionType & action, const size_t repetitions);
+    void getNodeState(const size_t nodeIndex, GameState & state);
+    SearchNode getNode(const size_t thread, const size_t nodeIndex) const;
+    BuildOrder getBuildOrder(const size_t thread, const size_t nodeIndex) const;
+    int getUpperBound() const;
+    void searchParallel();
+    void searchThread();
+    void receiveChildren();
+    void updateBestSolution(const GameState & state, const size_t parent, const ActionType & action = ActionTypes::None, const size_t repetitions = 0);
     void updateBestSolution(const GameState & state, const BuildOrder & buildOrder);
+    size_t getMemoryUsage() const;
+    void searchIterativeDeepening(int threshold);
+    void searchIterativeDeepeningDFS(GameState & state, BuildOrder & buildOrder, const int threshold, int & nextThreshold);
 
     const RaceID getRace() const;
 
@@ -96,14 +181,19 @@ public:
     void setGoal(const BuildOrderSearchGoal & goal);
     void setState(const GameState & state);
     void setTimeLimit(int ms);
+    void setMemoryLimitMB(int mb);
+    void setNumThreads(size_t numThreads);
     void setPrintNewBest(bool printNewBest);
     void setSmartSearch(bool smartSearch);
+    void setStoreNodeStates(bool storeNodeStates);
+    void setUseBucketQueue(bool useBucketQueue);
     void setOrdering(ActionOrderingType ordering);
     void setRelevantActions(const std::vector<ActionType> & relevantActions);
     void setUseRepetitions(bool val);
     void setUseIncreasingRepetitions(bool val);
     void setUseLandmarkLowerBound(bool val);
     void setUseResourceLowerBound(bool val);
+    void setUseBuilderLowerBound(bool val);
     void setUseAlwaysMakeWorkers(bool val);
     void setUseSupplyBounding(bool val);
     void setSupplyBoundingThreshold(double val);
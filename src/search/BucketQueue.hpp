@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Common.h"
+
+namespace BOSS
+{
+
+// priority queue for entries with a small non-negative integer priority, lowest priority first
+// entries are kept in one bucket per priority and come out of a bucket in the order they went in,
+// so push is O(1) and pop only has to skip over empty buckets below the next entry
+template <class T>
+class BucketQueue
+{
+    struct Bucket
+    {
+        std::vector<T>  entries;
+        size_t          head = 0;   // index of the next entry to pop
+    };
+
+    std::vector<Bucket> m_buckets;          // indexed by priority
+    size_t              m_minPriority = 0;  // no bucket below this has anything in it
+    size_t              m_size = 0;
+
+    void skipEmptyBuckets()
+    {
+        while (m_buckets[m_minPriority].head == m_buckets[m_minPriority].entries.size())
+        {
+            ++m_minPriority;
+        }
+    }
+
+public:
+
+    void push(const T & entry)
+    {
+        BOSS_ASSERT(entry.priority >= 0, "BucketQueue priorities can't be negative: %d", entry.priority);
+
+        const size_t priority = static_cast<size_t>(entry.priority);
+        if (priority >= m_buckets.size())
+        {
+            m_buckets.resize(priority + 1);
+        }
+
+        if (m_size == 0 || priority < m_minPriority)
+        {
+            m_minPriority = priority;
+        }
+
+        m_buckets[priority].entries.push_back(entry);
+        ++m_size;
+    }
+
+    const T & top()
+    {
+        BOSS_ASSERT(m_size > 0, "Can't take the top of an empty BucketQueue");
+
+        skipEmptyBuckets();
+        const Bucket & bucket = m_buckets[m_minPriority];
+        return bucket.entries[bucket.head];
+    }
+
+    void pop()
+    {
+        BOSS_ASSERT(m_size > 0, "Can't pop an empty BucketQueue");
+
+        skipEmptyBuckets();
+        Bucket & bucket = m_buckets[m_minPriority];
+        ++bucket.head;
+        --m_size;
+
+        // reuse the bucket's memory once everything in it has been popped
+        if (bucket.head == bucket.entries.size())
+        {
+            bucket.entries.clear();
+            bucket.head = 0;
+        }
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    void clear()
+    {
+        m_buckets.clear();
+        m_minPriority = 0;
+        m_size = 0;
+    }
+};
+
+}
@@ -8,25 +8,18 @@ using namespace BOSS;
 void CombatSearch::search()
 {
     m_searchTimer.start();
+    m_deadline.start(m_params.getSearchTimeLimit());
 
     // apply the opening build order to the initial state
     GameState initialState(m_params.getInitialState());
     m_buildOrder = m_params.getOpeningBuildOrder();
     Tools::DoBuildOrder(initialState, m_buildOrder);
 
-    try
-    {
-        recurse(initialState, 0);
-    
-        m_results.solved = true;
-    }
-    catch (int e)
-    {
-        if (e == BOSS_COMBATSEARCH_TIMEOUT)
-        {
-            m_results.timedOut = true;
-        }
-    }
+    recurse(initialState, 0);
+
+    m_deadline.stop();
+    m_results.timedOut = timeLimitReached();
+    m_results.solved = !m_results.timedOut;
 
     m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
 }
@@ -105,7 +98,7 @@ const CombatSearchResults & CombatSearch::getResults() const
 
 bool CombatSearch::timeLimitReached()
 {
-    return (m_params.getSearchTimeLimit() && (m_results.nodesExpanded % 100 == 0) && (m_searchTimer.getElapsedTimeInMilliSec() > m_params.getSearchTimeLimit()));
+    return m_deadline.expired();
 }
 
 bool CombatSearch::isTerminalNode(const GameState & s, size_t depth)
@@ -127,7 +120,7 @@ void CombatSearch::recurse(const GameState & state, size_t depth)
 
     //if (timeLimitReached())
     //{
-    //    throw BOSS_COMBATSEARCH_TIMEOUT;
+    //    return;
     //}
 
     //updateResults(state);
@@ -2,6 +2,7 @@
 
 #include "Common.h"
 #include "Timer.hpp"
+#include "Deadline.hpp"
 #include "Eval.h"
 #include "BuildOrder.h"
 #include "CombatSearchParameters.h"
@@ -10,7 +11,6 @@
 namespace BOSS
 {
 
-#define BOSS_COMBATSEARCH_TIMEOUT -1
 #define MAX_COMBAT_SEARCH_DEPTH 100
 
 
@@ -23,6 +23,7 @@ protected:
 
     int                         m_upperBound; 		// the current upper bound for search
     Timer                       m_searchTimer;
+    Deadline                    m_deadline;         // expires when the search time limit is reached
 
     BuildOrder                  m_buildOrder;
 
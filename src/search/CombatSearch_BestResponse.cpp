@@ -15,7 +15,7 @@ void CombatSearch_BestResponse::recurse(const GameState & state, size_t depth)
 {
     if (timeLimitReached())
     {
-        throw BOSS_COMBATSEARCH_TIMEOUT;
+        return;
     }
 
     m_bestResponseData.update(m_params.getInitialState(), state, m_buildOrder);
@@ -40,6 +40,11 @@ void CombatSearch_BestResponse::recurse(const GameState & state, size_t depth)
         recurse(child,depth+1);
 
         m_buildOrder.pop_back();
+
+        if (timeLimitReached())
+        {
+            return;
+        }
     }
 }
 
@@ -13,7 +13,7 @@ void CombatSearch_Bucket::recurse(const GameState & state, size_t depth)
 {
     if (timeLimitReached())
     {
-        throw BOSS_COMBATSEARCH_TIMEOUT;
+        return;
     }
 
     updateResults(state);
@@ -41,6 +41,11 @@ void CombatSearch_Bucket::recurse(const GameState & state, size_t depth)
         recurse(child,depth+1);
 
         m_buildOrder.pop_back();
+
+        if (timeLimitReached())
+        {
+            return;
+        }
     }
 }
 
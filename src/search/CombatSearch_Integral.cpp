@@ -13,7 +13,7 @@ void CombatSearch_Integral::recurse(const GameState & state, size_t depth)
 {
     if (timeLimitReached())
     {
-        throw BOSS_COMBATSEARCH_TIMEOUT;
+        return;
     }
 
     updateResults(state);
@@ -39,6 +39,11 @@ void CombatSearch_Integral::recurse(const GameState & state, size_t depth)
 
         m_buildOrder.pop_back();
         m_integral.pop();
+
+        if (timeLimitReached())
+        {
+            return;
+        }
     }
 }
 
@@ -11,6 +11,10 @@ DFBB_BuildOrderSearchParameters::DFBB_BuildOrderSearchParameters()
     , m_supplyBoundingThreshold(1)
     , m_useLandmarkLowerBoundHeuristic(true)
     , m_useResourceLowerBoundHeuristic(true)
+    , m_useBuilderLowerBoundHeuristic(true)
+    , m_useTranspositionTable(false)
+    , m_transpositionTableSize(1 << 20)
+    , m_numThreads(1)
     , m_printNewBest(false)
     , m_ordering(ActionOrderingType::None)
     , m_searchTimeLimit(0)
@@ -61,8 +65,10 @@ std::string DFBB_BuildOrderSearchParameters::toString() const
     ss << (m_useIncreasingRepetitions ?          "\tUSE      Increasing Repetitions\n" : "");
     ss << (m_useLandmarkLowerBoundHeuristic ?    "\tUSE      Landmark Lower Bound\n" : "");
     ss << (m_useResourceLowerBoundHeuristic ?    "\tUSE      Resource Lower Bound\n" : "");
+    ss << (m_useBuilderLowerBoundHeuristic ?     "\tUSE      Builder Lower Bound\n" : "");
     ss << (m_useAlwaysMakeWorkers ?              "\tUSE      Always Make Workers\n" : "");
     ss << (m_useSupplyBounding ?                 "\tUSE      Supply Bounding\n" : "");
+    ss << (m_useTranspositionTable ?             "\tUSE      Transposition Table\n" : "");
     ss << ("\n");
 
     for (ActionID a(0); a < m_repetitionValues.size(); ++a)
@@ -68,6 +68,24 @@ public:
     //      false: the heuristic is not used
     bool m_useLandmarkLowerBoundHeuristic;
     bool m_useResourceLowerBoundHeuristic;
+    bool m_useBuilderLowerBoundHeuristic;
+
+    //      Flag which determines whether or not we use a transposition table in our search
+    //      The same state can be reached by doing actions in a different order, and without a
+    //          transposition table its whole subtree is searched again each time. The table
+    //          remembers the best finish time for up to transpositionTableSize state hashes
+    //          and prunes any transposition which does not improve on it.
+    //
+    //      true:  the transposition table is used
+    //      false: the transposition table is not used
+    bool m_useTranspositionTable;
+    size_t m_transpositionTableSize;
+
+    //      Number of threads used by the search
+    //      With more than one thread the top of the search tree is split into subtrees which
+    //          are searched in parallel, all pruning against the best solution found by any of them.
+    //          A value of 1 runs the original single threaded search.
+    size_t m_numThreads;
 
     bool m_printNewBest;
     ActionOrderingType m_ordering;
@@ -8,6 +8,9 @@ DFBB_BuildOrderSearchResults::DFBB_BuildOrderSearchResults()
     , solutionFound(false)
     , upperBound(0)
     , nodesExpanded(0)
+    , transpositionHits(0)
+    , transpositionMisses(0)
+    , transpositionPrunes(0)
     , timeElapsed(0)
 {
 }
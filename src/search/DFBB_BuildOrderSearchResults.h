@@ -21,6 +21,10 @@ public:
 	int					        upperBound;		// upper bound of first node
 	
 	unsigned long long 	        nodesExpanded;	// number of nodes expanded in the search
+
+    unsigned long long          transpositionHits;      // transposition table lookups which found the state
+    unsigned long long          transpositionMisses;    // transposition table lookups which did not find the state
+    unsigned long long          transpositionPrunes;    // states pruned because the table held an equal or better finish time
 	
 	double 				        timeElapsed;	// time elapsed in milliseconds
 
@@ -12,9 +12,12 @@ DFBB_BuildOrderSmartSearch::DFBB_BuildOrderSmartSearch()
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
+    , m_useTranspositionTable(false)
+    , m_numThreads(1)
 {
 }
 
@@ -37,9 +40,12 @@ void DFBB_BuildOrderSmartSearch::doSearch()
         m_params.m_useIncreasingRepetitions         = m_useIncreasingRepetitions;
         m_params.m_useLandmarkLowerBoundHeuristic   = m_useLandmarkLowerBound;
         m_params.m_useResourceLowerBoundHeuristic   = m_useResourceLowerBound;
+        m_params.m_useBuilderLowerBoundHeuristic    = m_useBuilderLowerBound;
         m_params.m_useAlwaysMakeWorkers             = m_useAlwaysMakeWorkers;
         m_params.m_useSupplyBounding                = m_useSupplyBounding;
         m_params.m_supplyBoundingThreshold          = m_supplyBoundingThreshold;
+        m_params.m_useTranspositionTable            = m_useTranspositionTable;
+        m_params.m_numThreads                       = m_numThreads;
         m_params.m_relevantActions                  = m_relevantActions;
         m_params.m_searchTimeLimit                  = m_searchTimeLimit;
         m_params.m_printNewBest                     = m_printNewBest;
@@ -320,9 +326,12 @@ void DFBB_BuildOrderSmartSearch::setUseRepetitions(bool val)           { m_useRe
 void DFBB_BuildOrderSmartSearch::setUseIncreasingRepetitions(bool val) { m_useIncreasingRepetitions = val; }
 void DFBB_BuildOrderSmartSearch::setUseLandmarkLowerBound(bool val)    { m_useLandmarkLowerBound = val; }
 void DFBB_BuildOrderSmartSearch::setUseResourceLowerBound(bool val)    { m_useResourceLowerBound = val; }
+void DFBB_BuildOrderSmartSearch::setUseBuilderLowerBound(bool val)     { m_useBuilderLowerBound = val; }
 void DFBB_BuildOrderSmartSearch::setUseAlwaysMakeWorkers(bool val)     { m_useAlwaysMakeWorkers = val; }
 void DFBB_BuildOrderSmartSearch::setUseSupplyBounding(bool val)        { m_useSupplyBounding = val; }
 void DFBB_BuildOrderSmartSearch::setSupplyBoundingThreshold(double val){ m_supplyBoundingThreshold = val; }
+void DFBB_BuildOrderSmartSearch::setUseTranspositionTable(bool val)    { m_useTranspositionTable = val; }
+void DFBB_BuildOrderSmartSearch::setNumThreads(size_t numThreads)      { m_numThreads = std::max((size_t)1, numThreads); }
 
 void DFBB_BuildOrderSmartSearch::search()
 {
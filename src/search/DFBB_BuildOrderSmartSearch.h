@@ -26,9 +26,12 @@ class DFBB_BuildOrderSmartSearch
     bool                                m_useIncreasingRepetitions;
     bool                                m_useLandmarkLowerBound;
     bool                                m_useResourceLowerBound;
+    bool                                m_useBuilderLowerBound;
     bool                                m_useAlwaysMakeWorkers;
     bool                                m_useSupplyBounding;
     double                              m_supplyBoundingThreshold;
+    bool                                m_useTranspositionTable;
+    size_t                              m_numThreads;
 
     Timer							    m_searchTimer;
 
@@ -62,9 +65,12 @@ public:
     void setUseIncreasingRepetitions(bool val);
     void setUseLandmarkLowerBound(bool val);
     void setUseResourceLowerBound(bool val);
+    void setUseBuilderLowerBound(bool val);
     void setUseAlwaysMakeWorkers(bool val);
     void setUseSupplyBounding(bool val);
     void setSupplyBoundingThreshold(double val);
+    void setUseTranspositionTable(bool val);
+    void setNumThreads(size_t numThreads);
 
     void search();
 
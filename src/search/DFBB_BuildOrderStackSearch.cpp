@@ -7,12 +7,15 @@ using namespace BOSS;
 
 DFBB_BuildOrderStackSearch::DFBB_BuildOrderStackSearch(const DFBB_BuildOrderSearchParameters & p)
     : m_params(p)
+    , m_deadline(std::make_shared<Deadline>())
+    , m_stack(100, StackData())
     , m_depth(0)
     , m_firstSearch(true)
     , m_wasInterrupted(false)
-    , m_stack(100, StackData())
 {
     const size_t numActions = ActionTypes::GetAllActionTypes().size();
+    m_lowerBound = LowerBoundEvaluator(m_params.m_goal, m_params.m_useLandmarkLowerBoundHeuristic, m_params.m_useResourceLowerBoundHeuristic, m_params.m_useBuilderLowerBoundHeuristic);
+    m_lowerBound.setRootState(m_params.m_initialState);
 
     if (m_params.m_ordering == ActionOrderingType::NaiveBuild)
     {
@@ -45,6 +48,11 @@ DFBB_BuildOrderStackSearch::DFBB_BuildOrderStackSearch(const DFBB_BuildOrderSear
     {
         m_stateOrderRanks.resize(numActions, 0);
     }
+
+    if (m_params.m_useTranspositionTable)
+    {
+        m_transpositionTable = std::make_shared<TranspositionTable>(m_params.m_transpositionTableSize);
+    }
 }
 
 void DFBB_BuildOrderStackSearch::setTimeLimit(double ms)
@@ -56,6 +64,7 @@ void DFBB_BuildOrderStackSearch::setTimeLimit(double ms)
 void DFBB_BuildOrderStackSearch::search()
 {
     m_searchTimer.start();
+    m_deadline->start(m_params.m_searchTimeLimit);
 
     if (!m_results.solved)
     {
@@ -66,28 +75,25 @@ void DFBB_BuildOrderStackSearch::search()
             // add one frame to the upper bound so our strictly lesser than check still works if we have an exact upper bound
             m_results.upperBound += 1;
 
-            m_stack[0].state = m_params.m_initialState;
+            m_state = m_params.m_initialState;
             m_firstSearch = false;
             //BWAPI::Broodwar->printf("Upper bound is %d", m_results.upperBound);
             //std::cout << "Upper bound is: " << m_results.upperBound << std::endl;
         }
 
-        try 
+        if (m_params.m_numThreads > 1)
         {
-            // search on the initial state
-            DFBB();
-
-            m_results.timedOut = false;
+            // split on the first search, later searches resume the remaining tasks and the threads' interrupted subtrees
+            searchParallel();
         }
-        catch (int e) 
+        else
         {
-            if (e == DFBB_TIMEOUT_EXCEPTION)
-            {
-                //BWAPI::Broodwar->printf("I timed out!");
-                m_results.timedOut = true;
-            }
+            // search on the initial state, or resume from the node a previous search timed out on
+            m_results.timedOut = false;
+            DFBB();
         }
         
+        m_deadline->stop();
         double ms = m_searchTimer.getElapsedTimeInMilliSec();
         m_results.solved = !m_results.timedOut;
         m_results.timeElapsed = ms;
@@ -215,15 +221,119 @@ size_t DFBB_BuildOrderStackSearch::getRepetitions(const GameState & state, const
 
 bool DFBB_BuildOrderStackSearch::isTimeOut()
 {
-    return (m_params.m_searchTimeLimit && (m_results.nodesExpanded % 200 == 0) && (m_searchTimer.getElapsedTimeInMilliSec() > m_params.m_searchTimeLimit));
+    return m_deadline->expired();
+}
+
+// returns true if this state has already been reached with an equal or better finish time, so its subtree can be skipped
+bool DFBB_BuildOrderStackSearch::isTransposition(const GameState & state)
+{
+    if (!m_transpositionTable) { return false; }
+
+    const uint64_t key = state.hash();
+    const int finishTime = state.getLastActionFinishTime();
+    int bestFinishTime = 0;
+
+    if (m_transpositionTable->lookup(key, bestFinishTime))
+    {
+        m_results.transpositionHits++;
+        if (bestFinishTime <= finishTime)
+        {
+            m_results.transpositionPrunes++;
+            return true;
+        }
+    }
+    else
+    {
+        m_results.transpositionMisses++;
+    }
+
+    m_transpositionTable->store(key, finishTime);
+    return false;
+}
+
+void DFBB_BuildOrderStackSearch::orderLegalActions(const GameState & state, ActionSet & legalActions)
+{
+    if (m_params.m_ordering == ActionOrderingType::LeastBuilt ||
+        m_params.m_ordering == ActionOrderingType::MostBuilt)
+    {
+        for (size_t i = 0; i < m_stateOrderRanks.size(); ++i)
+        {
+            m_stateOrderRanks[i] = state.getNumTotal(ActionType(i));
+        }
+        ActionOrdering::ApplyOrdering(legalActions, m_params.m_ordering, m_stateOrderRanks);
+    }
+    else
+    {
+        ActionOrdering::ApplyOrdering(legalActions, m_params.m_ordering, m_actionOrderRanks);
+    }
+}
+
+// the earliest frame the goal can be finished from this state, computed once per node rather than per child
+int DFBB_BuildOrderStackSearch::getLowerBound(const GameState & state) const
+{
+    return state.getCurrentFrame() + m_lowerBound.getLowerBound(state);
+}
+
+// returns true if doing this action can't lead to a solution better than the current upper bound
+bool DFBB_BuildOrderStackSearch::canPrune(const GameState & state, const ActionType & action, const int lowerBound)
+{
+    const int actionFinishTime = state.whenCanBuild(action) + action.buildTime();
+    const int maxHeuristic     = (actionFinishTime > lowerBound) ? actionFinishTime : lowerBound;
+
+    // once a solution reaches the heuristic table's bound for the whole search, nothing can beat it
+    return maxHeuristic > getUpperBound() || m_lowerBound.getTableFinishFrame() >= getUpperBound();
+}
+
+// does the action up to 'repetitions' times while it stays legal, returning how many times it was done
+size_t DFBB_BuildOrderStackSearch::doRepeatedAction(const ActionType & action, const size_t repetitions, UndoJournal & journal)
+{
+    size_t completedRepetitions = 0;
+    for (; completedRepetitions < repetitions; ++completedRepetitions)
+    {
+        if (!m_state.isLegal(action))
+        {
+            break;
+        }
+
+        m_buildOrder.add(action);
+        m_state.doAction(action, journal);
+    }
+
+    return completedRepetitions;
+}
+
+// the best solution so far, which during a parallel search is shared by every thread
+int DFBB_BuildOrderStackSearch::getUpperBound() const
+{
+    return m_parallelData ? m_parallelData->upperBound.load(std::memory_order_relaxed) : m_results.upperBound;
 }
 
 void DFBB_BuildOrderStackSearch::updateResults(const GameState & state)
 {
     int finishTime = state.getLastActionFinishTime();
 
+    if (m_parallelData && finishTime < getUpperBound())
+    {
+        // check again under the lock since another thread may have just found something better
+        std::lock_guard<std::mutex> lock(m_parallelData->resultsMutex);
+        DFBB_BuildOrderSearchResults & results = m_parallelData->results;
+        if (finishTime < results.upperBound)
+        {
+            results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+            results.upperBound = finishTime;
+            results.solutionFound = true;
+            results.finalState = state;
+            results.buildOrder = m_buildOrder;
+            m_parallelData->upperBound.store(finishTime, std::memory_order_relaxed);
+
+            if (m_params.m_printNewBest)
+            {
+                std::cout << finishTime << "   " << m_buildOrder.getNameString(2) << std::endl;
+            }
+        }
+    }
     // new best solution
-    if (finishTime < m_results.upperBound)
+    else if (!m_parallelData && finishTime < m_results.upperBound)
     {
         m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
         m_results.upperBound = finishTime;
@@ -239,12 +349,13 @@ void DFBB_BuildOrderStackSearch::updateResults(const GameState & state)
 }
 
 #define ACTION_TYPE     m_stack[m_depth].currentActionType
-#define STATE           m_stack[m_depth].state
-#define CHILD_STATE     m_stack[m_depth+1].state
+#define STATE           m_state
+#define JOURNAL         m_stack[m_depth].journal
 #define CHILD_NUM       m_stack[m_depth].currentChildIndex
 #define LEGAL_ACTIONS   m_stack[m_depth].legalActions
 #define REPETITIONS     m_stack[m_depth].repetitionValue
 #define COMPLETED_REPS  m_stack[m_depth].completedRepetitions
+#define LOWER_BOUND     m_stack[m_depth].lowerBound
 
 #define DFBB_CALL_RETURN  if (m_depth == 0) { return; } else { --m_depth; goto SEARCH_RETURN; }
 #define DFBB_CALL_RECURSE { ++m_depth; if (m_depth >= m_stack.size()) { m_stack.resize(m_depth + 64); } goto SEARCH_BEGIN; }
@@ -252,42 +363,26 @@ void DFBB_BuildOrderStackSearch::updateResults(const GameState & state)
 // recursive function which does all search logic
 void DFBB_BuildOrderStackSearch::DFBB()
 {
-    int actionFinishTime = 0;
-    int heuristicTime = 0;
-    int maxHeuristic = 0;
-
 SEARCH_BEGIN:
 
     m_results.nodesExpanded++;
 
+    // leave the stack as it is so that a later call to search() resumes from this node
     if (isTimeOut())
     {
-        throw DFBB_TIMEOUT_EXCEPTION;
+        m_results.timedOut = true;
+        return;
     }
 
     generateLegalActions(STATE, LEGAL_ACTIONS);
-    if (m_params.m_ordering == ActionOrderingType::LeastBuilt ||
-        m_params.m_ordering == ActionOrderingType::MostBuilt)
-    {
-        for (size_t i = 0; i < m_stateOrderRanks.size(); ++i)
-        {
-            m_stateOrderRanks[i] = STATE.getNumTotal(ActionType(i));
-        }
-        ActionOrdering::ApplyOrdering(LEGAL_ACTIONS, m_params.m_ordering, m_stateOrderRanks);
-    }
-    else
-    {
-        ActionOrdering::ApplyOrdering(LEGAL_ACTIONS, m_params.m_ordering, m_actionOrderRanks);
-    }
+    orderLegalActions(STATE, LEGAL_ACTIONS);
+    LOWER_BOUND = getLowerBound(STATE);
+
     for (CHILD_NUM = 0; CHILD_NUM < LEGAL_ACTIONS.size(); ++CHILD_NUM)
     {
         ACTION_TYPE = LEGAL_ACTIONS[CHILD_NUM];
 
-        actionFinishTime = STATE.whenCanBuild(ACTION_TYPE) + ACTION_TYPE.buildTime();
-        heuristicTime    = STATE.getCurrentFrame() + Tools::GetLowerBound(STATE, m_params.m_goal);
-        maxHeuristic     = (actionFinishTime > heuristicTime) ? actionFinishTime : heuristicTime;
-
-        if (maxHeuristic > m_results.upperBound)
+        if (canPrune(STATE, ACTION_TYPE, LOWER_BOUND))
         {
             continue;
         }
@@ -295,27 +390,15 @@ SEARCH_BEGIN:
         REPETITIONS = getRepetitions(STATE, ACTION_TYPE);
         BOSS_ASSERT(REPETITIONS > 0, "Can't have zero repetitions!");
                 
-        // do the action as many times as legal to to 'repeat'
-        CHILD_STATE = STATE;
-        COMPLETED_REPS = 0;
-        for (; COMPLETED_REPS < REPETITIONS; ++COMPLETED_REPS)
-        {
-            if (CHILD_STATE.isLegal(ACTION_TYPE))
-            {
-                m_buildOrder.add(ACTION_TYPE);
-                CHILD_STATE.doAction(ACTION_TYPE);
-            }
-            else
-            {
-                break;
-            }
-        }
+        // do the action as many times as legal to to 'repeat', journaling the changes so we can undo them after
+        JOURNAL.clear();
+        COMPLETED_REPS = doRepeatedAction(ACTION_TYPE, REPETITIONS, JOURNAL);
 
-        if (m_params.m_goal.isAchievedBy(CHILD_STATE))
+        if (m_params.m_goal.isAchievedBy(STATE))
         {
-            updateResults(CHILD_STATE);
+            updateResults(STATE);
         }
-        else
+        else if (!isTransposition(STATE))
         {
             DFBB_CALL_RECURSE;
         }
@@ -326,7 +409,173 @@ SEARCH_RETURN:
         {
             m_buildOrder.pop_back();
         }
+
+        STATE.undoAction(JOURNAL);
     }
 
     DFBB_CALL_RETURN;
 }
+
+// splits the top of the search tree into subtrees and searches them on m_params.m_numThreads threads
+// each thread owns a queue of subtrees and steals from the back of the others' queues once its own is empty
+// the split, the queues and each thread's stack outlive a timeout, so calling search() again resumes where this one stopped
+void DFBB_BuildOrderStackSearch::searchParallel()
+{
+    const size_t numThreads = m_params.m_numThreads;
+
+    if (m_parallelWorkers.empty())
+    {
+        // copy the workers before splitting so they don't carry a copy of the tasks, or of each other
+        std::vector<std::shared_ptr<DFBB_BuildOrderStackSearch>> workers;
+        for (size_t t(0); t < numThreads; ++t)
+        {
+            workers.push_back(std::make_shared<DFBB_BuildOrderStackSearch>(*this));
+        }
+        m_parallelWorkers.swap(workers);
+
+        // expand the frontier one level at a time until there's enough work to go around
+        // expanding every task in order keeps the tasks in the same order the serial search would visit them
+        // this only happens once, since the transposition table would prune every task we've already stored in it
+        m_parallelTasks = { DFBB_SearchTask{ m_params.m_initialState, BuildOrder() } };
+        for (size_t depth(0); depth < MaxParallelSplitDepth && !m_parallelTasks.empty() && m_parallelTasks.size() < numThreads * TasksPerThread; ++depth)
+        {
+            std::vector<DFBB_SearchTask> children;
+            for (const DFBB_SearchTask & task : m_parallelTasks)
+            {
+                expandTask(task, children);
+            }
+            m_parallelTasks.swap(children);
+        }
+
+        // deal the tasks out round robin so every thread starts on one of the earliest subtrees
+        m_parallelQueues.assign(numThreads, std::deque<size_t>());
+        for (size_t t(0); t < m_parallelTasks.size(); ++t)
+        {
+            m_parallelQueues[t % numThreads].push_back(t);
+        }
+    }
+
+    DFBB_ParallelSearchData shared;
+    shared.upperBound = m_results.upperBound;
+    shared.results = m_results;
+
+    std::vector<std::mutex> queueMutexes(numThreads);
+    auto getTask = [&](const size_t thread, size_t & task)
+    {
+        for (size_t i(0); i < numThreads; ++i)
+        {
+            const size_t victim = (thread + i) % numThreads;
+            std::lock_guard<std::mutex> lock(queueMutexes[victim]);
+            std::deque<size_t> & queue = m_parallelQueues[victim];
+            if (queue.empty()) { continue; }
+
+            // take the earliest task from our own queue, and the latest from anyone else's
+            if (victim == thread) { task = queue.front(); queue.pop_front(); }
+            else                  { task = queue.back();  queue.pop_back(); }
+            return true;
+        }
+
+        return false;
+    };
+
+    std::vector<DFBB_BuildOrderSearchResults> threadResults(numThreads);
+    std::vector<std::thread> threads;
+    for (size_t t(0); t < numThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            DFBB_BuildOrderStackSearch & worker = *m_parallelWorkers[t];
+            const bool resume = worker.m_results.timedOut;
+            worker.m_parallelData = &shared;
+            worker.m_results = DFBB_BuildOrderSearchResults();
+
+            // finish the subtree the last search timed out in before taking a new one
+            if (resume)
+            {
+                worker.DFBB();
+            }
+
+            size_t task = 0;
+            while (!worker.m_results.timedOut && !worker.isTimeOut() && getTask(t, task))
+            {
+                worker.m_state = m_parallelTasks[task].state;
+                worker.m_buildOrder = m_parallelTasks[task].buildOrder;
+                worker.m_depth = 0;
+                worker.DFBB();
+            }
+
+            threadResults[t] = worker.m_results;
+            worker.m_parallelData = nullptr;
+        });
+    }
+
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+
+    const unsigned long long nodesExpanded = m_results.nodesExpanded;
+    const DFBB_BuildOrderSearchResults splitResults = m_results;
+    m_results = shared.results;
+    m_results.nodesExpanded         = nodesExpanded;
+    m_results.transpositionHits     = splitResults.transpositionHits;
+    m_results.transpositionMisses   = splitResults.transpositionMisses;
+    m_results.transpositionPrunes   = splitResults.transpositionPrunes;
+    m_results.timedOut              = false;
+    for (const DFBB_BuildOrderSearchResults & results : threadResults)
+    {
+        m_results.nodesExpanded         += results.nodesExpanded;
+        m_results.transpositionHits     += results.transpositionHits;
+        m_results.transpositionMisses   += results.transpositionMisses;
+        m_results.transpositionPrunes   += results.transpositionPrunes;
+        m_results.timedOut              |= results.timedOut;
+    }
+
+    // a thread can also stop between tasks, leaving some that were never started
+    for (const std::deque<size_t> & queue : m_parallelQueues)
+    {
+        m_results.timedOut |= !queue.empty();
+    }
+}
+
+// generates the children of a task's state exactly as DFBB would, adding the unsolved ones as new tasks
+void DFBB_BuildOrderStackSearch::expandTask(const DFBB_SearchTask & task, std::vector<DFBB_SearchTask> & children)
+{
+    m_state = task.state;
+    m_buildOrder = task.buildOrder;
+    m_results.nodesExpanded++;
+
+    ActionSet legalActions;
+    generateLegalActions(m_state, legalActions);
+    orderLegalActions(m_state, legalActions);
+    const int lowerBound = getLowerBound(m_state);
+
+    UndoJournal journal;
+    for (size_t a(0); a < legalActions.size(); ++a)
+    {
+        const ActionType actionType = legalActions[a];
+        if (canPrune(m_state, actionType, lowerBound))
+        {
+            continue;
+        }
+
+        journal.clear();
+        const size_t completedRepetitions = doRepeatedAction(actionType, getRepetitions(m_state, actionType), journal);
+
+        if (m_params.m_goal.isAchievedBy(m_state))
+        {
+            updateResults(m_state);
+        }
+        else if (!isTransposition(m_state))
+        {
+            children.push_back(DFBB_SearchTask{ m_state, m_buildOrder });
+        }
+
+        for (size_t r(0); r < completedRepetitions; ++r)
+        {
+            m_buildOrder.pop_back();
+        }
+
+        m_state.undoAction(journal);
+    }
+}
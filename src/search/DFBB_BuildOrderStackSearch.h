@@ -5,10 +5,16 @@
 #include "DFBB_BuildOrderSearchResults.h"
 #include "DFBB_BuildOrderSearchParameters.h"
 #include "Timer.hpp"
+#include "Deadline.hpp"
 #include "BuildOrder.h"
 #include "ActionSet.h"
+#include "TranspositionTable.h"
+#include "LowerBoundEvaluator.h"
 
-#define DFBB_TIMEOUT_EXCEPTION 1
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace BOSS
 {
@@ -18,28 +24,52 @@ class StackData
 public:
 
     size_t              currentChildIndex;
-    GameState           state;
+    UndoJournal         journal;            // changes made to the search state by the current child's actions
     ActionSet           legalActions;
     ActionType          currentActionType;
     size_t              repetitionValue;
     size_t              completedRepetitions;
+    int                 lowerBound;         // earliest frame the goal can be finished from this node, the same for all its children
     
     StackData()
         : currentChildIndex(0)
         , repetitionValue(1)
         , completedRepetitions(0)
+        , lowerBound(0)
     {
     
     }
 };
 
+// a subtree handed to one thread of a parallel search
+struct DFBB_SearchTask
+{
+    GameState   state;
+    BuildOrder  buildOrder;
+};
+
+// everything the threads of a parallel search share
+struct DFBB_ParallelSearchData
+{
+    std::atomic<int>                upperBound  { 0 };      // best finish time found by any thread, used for pruning
+    std::mutex                      resultsMutex;
+    DFBB_BuildOrderSearchResults    results;                // best solution found by any thread
+};
+
 class DFBB_BuildOrderStackSearch
 {
+    static const size_t MaxParallelSplitDepth   = 6;    // deepest level the tree is split at for a parallel search
+    static const size_t TasksPerThread          = 16;   // how many subtrees per thread to split into, for load balancing
+
 	DFBB_BuildOrderSearchParameters     m_params;                      //parameters that will be used in this search
 	DFBB_BuildOrderSearchResults        m_results;                     //the results of the search so far
 					
     Timer                               m_searchTimer;
+    std::shared_ptr<Deadline>           m_deadline;           // expires at the time limit, shared with the threads of a parallel search
     BuildOrder                          m_buildOrder;
+    GameState                           m_state;              // the single state searched on, actions are undone when backtracking
+    std::shared_ptr<TranspositionTable> m_transpositionTable; // best finish time seen per state hash, if enabled
+    LowerBoundEvaluator                 m_lowerBound;         // the enabled lower bound heuristics for the goal
 
     std::vector<StackData>              m_stack;
     size_t                              m_depth;
@@ -49,10 +79,25 @@ class DFBB_BuildOrderStackSearch
     bool                                m_firstSearch;
 
     bool                                m_wasInterrupted;
+
+    DFBB_ParallelSearchData *           m_parallelData = nullptr;
+
+    // a parallel search keeps its split and its threads' stacks between calls to search() so it can resume after a timeout
+    std::vector<DFBB_SearchTask>                            m_parallelTasks;
+    std::vector<std::deque<size_t>>                         m_parallelQueues;     // indices into m_parallelTasks not started yet, per thread
+    std::vector<std::shared_ptr<DFBB_BuildOrderStackSearch>> m_parallelWorkers;   // a worker whose results timed out resumes its stack first
     
     void                                updateResults(const GameState & state);
     bool                                isTimeOut();
+    bool                                isTransposition(const GameState & state);
     void                                generateLegalActions(const GameState & state, ActionSet & legalActions);
+    void                                orderLegalActions(const GameState & state, ActionSet & legalActions);
+    bool                                canPrune(const GameState & state, const ActionType & action, const int lowerBound);
+    int                                 getLowerBound(const GameState & state) const;
+    size_t                              doRepeatedAction(const ActionType & action, const size_t repetitions, UndoJournal & journal);
+    int                                 getUpperBound() const;
+    void                                searchParallel();
+    void                                expandTask(const DFBB_SearchTask & task, std::vector<DFBB_SearchTask> & children);
 	std::vector<ActionType>             getBuildOrder(GameState & state);
     size_t                              getRepetitions(const GameState & state, const ActionType & a);
     std::vector<ActionType>             calculateRelevantActions();
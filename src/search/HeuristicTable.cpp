@@ -0,0 +1,404 @@
+#include "HeuristicTable.h"
+#include "DFBB_BuildOrderStackSearch.h"
+#include "LowerBoundEvaluator.h"
+
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+
+using namespace BOSS;
+
+namespace
+{
+    const char     FileMagic[8] = { 'B', 'O', 'S', 'S', 'H', 'T', 'B', 'L' };
+    const uint32_t FileVersion  = 2;
+
+    // how many more workers than the state has a table search may make, far more than any key type goal needs
+    const size_t   ExtraWorkers = 20;
+
+    // tables by the key of the state they were built from
+    std::unordered_map<std::string, HeuristicTable> Tables;
+
+    template <class T>
+    void WriteValue(std::ostream & out, const T & value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <class T>
+    T ReadValue(std::istream & in)
+    {
+        T value{};
+        in.read(reinterpret_cast<char *>(&value), sizeof(T));
+        BOSS_ASSERT(in.good(), "Heuristic table file ended early");
+        return value;
+    }
+
+    void WriteString(std::ostream & out, const std::string & value)
+    {
+        WriteValue<uint32_t>(out, (uint32_t)value.size());
+        out.write(value.data(), value.size());
+    }
+
+    std::string ReadString(std::istream & in)
+    {
+        std::string value(ReadValue<uint32_t>(in), ' ');
+        in.read(&value[0], value.size());
+        BOSS_ASSERT(in.good(), "Heuristic table file ended early");
+        return value;
+    }
+
+    // parameters for a search without the abstractions the smart search uses to go faster. the goal max allows every type the goal
+    // needs, a producer for each goal unit, a refinery per depot if it needs gas, 20 extra workers and the supply for all of them,
+    // but no new depots, so an entry is optimal among build orders within those limits. Build only takes buildings that don't add
+    // a depot as key types, which those limits aren't expected to delay, and that is what makes an entry a lower bound
+    DFBB_BuildOrderSearchParameters GetExactSearchParameters(const GameState & state, const BuildOrderSearchGoal & goal)
+    {
+        const RaceID race                   = state.getRace();
+        const ActionType & worker           = ActionTypes::GetWorker(race);
+        const ActionType & resourceDepot    = ActionTypes::GetResourceDepot(race);
+        const ActionType & refinery         = ActionTypes::GetRefinery(race);
+        const ActionType & supplyProvider   = ActionTypes::GetSupplyProvider(race);
+
+        BuildOrderSearchGoal searchGoal = goal;
+        std::vector<size_t> numBuiltBy(ActionTypes::GetAllActionTypes().size(), 0);
+        int supplyNeeded = state.getCurrentSupply() + (int)ExtraWorkers * worker.supplyCost();
+        bool gasNeeded = false;
+
+        for (const ActionType & type : ActionTypes::GetAllActionTypes())
+        {
+            if (goal.getGoal(type) == 0)
+            {
+                continue;
+            }
+
+            const ActionSet & prerequisites = type.getRecursivePrerequisiteActionCount();
+            for (size_t p(0); p < prerequisites.size(); ++p)
+            {
+                searchGoal.setGoalMax(prerequisites[p], std::max(searchGoal.getGoalMax(prerequisites[p]), (size_t)1));
+                gasNeeded |= prerequisites[p].gasPrice() > 0;
+            }
+
+            numBuiltBy[type.whatBuilds().getID()] += goal.getGoal(type);
+            supplyNeeded += (int)goal.getGoal(type) * type.supplyCost();
+            gasNeeded |= type.gasPrice() > 0;
+        }
+
+        // a goal max below the goal would make the goal unreachable, since a type's goal max applies even when it's in the goal
+        for (const ActionType & type : ActionTypes::GetAllActionTypes())
+        {
+            if (numBuiltBy[type.getID()] > 0 && type.isBuilding() && !type.isDepot())
+            {
+                searchGoal.setGoalMax(type, std::max(searchGoal.getGoalMax(type), numBuiltBy[type.getID()]));
+            }
+
+            searchGoal.setGoalMax(type, std::max(searchGoal.getGoalMax(type), goal.getGoal(type)));
+        }
+
+        const int supplyShort = std::max(0, supplyNeeded - state.getMaxSupply() - state.getSupplyInProgress());
+        const size_t supplyProviders = (supplyShort + supplyProvider.supplyProvided() - 1) / supplyProvider.supplyProvided();
+
+        searchGoal.setGoalMax(worker,         std::max(searchGoal.getGoalMax(worker), state.getNumTotal(worker) + ExtraWorkers));
+        searchGoal.setGoalMax(resourceDepot,  state.getNumTotal(resourceDepot));
+        searchGoal.setGoalMax(refinery,       std::max(searchGoal.getGoalMax(refinery), gasNeeded ? state.getNumTotal(resourceDepot) : 0));
+        searchGoal.setGoalMax(supplyProvider, std::max(searchGoal.getGoalMax(supplyProvider), state.getNumTotal(supplyProvider) + supplyProviders));
+
+        DFBB_BuildOrderSearchParameters params;
+        params.m_goal                   = searchGoal;
+        params.m_initialState           = state;
+        params.m_useRepetitions         = false;
+        params.m_useTranspositionTable  = true;
+
+        for (const ActionType & type : ActionTypes::GetAllActionTypes())
+        {
+            if (type.getRace() == race && (searchGoal.getGoal(type) > 0 || searchGoal.getGoalMax(type) > 0))
+            {
+                params.m_relevantActions.push_back(type);
+            }
+        }
+
+        return params;
+    }
+}
+
+HeuristicTable::HeuristicTable()
+{
+
+}
+
+HeuristicTable::HeuristicTable(const GameState & state, const std::vector<std::pair<ActionType, size_t>> & keyTypes)
+    : m_stateKey(state.getNameKey())
+{
+    BOSS_ASSERT(keyTypes.size() <= MaxKeyTypes, "A heuristic table can have at most %d key types", (int)MaxKeyTypes);
+
+    size_t size = 1;
+    for (const auto & keyType : keyTypes)
+    {
+        m_keyTypes.push_back(keyType.first);
+        m_maxCounts.push_back(keyType.second);
+        size *= keyType.second + 1;
+    }
+
+    m_makespans.assign(size, 0);
+    calculateRequiredKeys();
+}
+
+// the key types in each type's recursive prerequisites, so that projecting a goal only needs its own types
+void HeuristicTable::calculateRequiredKeys()
+{
+    const size_t numTypes = ActionTypes::GetAllActionTypes().size();
+    m_requiredKeys.assign(numTypes, 0);
+    std::vector<bool> calculated(numTypes, false);
+
+    std::function<uint32_t(const ActionType &)> requiredKeys = [&](const ActionType & type) -> uint32_t
+    {
+        if (!calculated[type.getID()])
+        {
+            calculated[type.getID()] = true;
+
+            uint32_t keys = 0;
+            const ActionSet & prerequisites = type.getPrerequisiteActionCount();
+            for (size_t p(0); p < prerequisites.size(); ++p)
+            {
+                keys |= requiredKeys(prerequisites[p]);
+                for (size_t k(0); k < m_keyTypes.size(); ++k)
+                {
+                    if (m_keyTypes[k] == prerequisites[p])
+                    {
+                        keys |= 1u << k;
+                    }
+                }
+            }
+
+            m_requiredKeys[type.getID()] = keys;
+        }
+
+        return m_requiredKeys[type.getID()];
+    };
+
+    for (const ActionType & type : ActionTypes::GetAllActionTypes())
+    {
+        requiredKeys(type);
+    }
+}
+
+const std::string & HeuristicTable::getStateKey() const
+{
+    return m_stateKey;
+}
+
+size_t HeuristicTable::size() const
+{
+    return m_makespans.size();
+}
+
+// the goal projected onto the key types: its own count of each, at least one of each it needs, and at most the table's max
+size_t HeuristicTable::getIndex(const BuildOrderSearchGoal & goal) const
+{
+    uint32_t requiredKeys = 0;
+    for (const ActionType & type : ActionTypes::GetAllActionTypes())
+    {
+        if (goal.getGoal(type) > 0)
+        {
+            requiredKeys |= m_requiredKeys[type.getID()];
+        }
+    }
+
+    size_t index = 0;
+    size_t stride = 1;
+    for (size_t k(0); k < m_keyTypes.size(); ++k)
+    {
+        size_t count = goal.getGoal(m_keyTypes[k]);
+        if (requiredKeys & (1u << k))
+        {
+            count = std::max(count, (size_t)1);
+        }
+
+        index += std::min(count, m_maxCounts[k]) * stride;
+        stride *= m_maxCounts[k] + 1;
+    }
+
+    return index;
+}
+
+BuildOrderSearchGoal HeuristicTable::getGoal(const size_t index) const
+{
+    BOSS_ASSERT(index < size(), "Heuristic table index out of range: %d", (int)index);
+
+    BuildOrderSearchGoal goal;
+    size_t remaining = index;
+    for (size_t k(0); k < m_keyTypes.size(); ++k)
+    {
+        const size_t count = remaining % (m_maxCounts[k] + 1);
+        remaining /= m_maxCounts[k] + 1;
+
+        if (count > 0)
+        {
+            goal.setGoal(m_keyTypes[k], count);
+        }
+    }
+
+    return goal;
+}
+
+int HeuristicTable::getMakespan(const size_t index) const
+{
+    return m_makespans[index];
+}
+
+void HeuristicTable::setMakespan(const size_t index, const int makespan)
+{
+    m_makespans[index] = makespan;
+}
+
+// the state key and key types are written by name so a table still loads if the data file's type IDs change
+void HeuristicTable::write(std::ostream & out) const
+{
+    WriteString(out, m_stateKey);
+    WriteValue<uint32_t>(out, (uint32_t)m_keyTypes.size());
+    for (size_t k(0); k < m_keyTypes.size(); ++k)
+    {
+        WriteString(out, m_keyTypes[k].getName());
+        WriteValue<uint32_t>(out, (uint32_t)m_maxCounts[k]);
+    }
+
+    WriteValue<uint32_t>(out, (uint32_t)m_makespans.size());
+    for (const int makespan : m_makespans)
+    {
+        WriteValue<int32_t>(out, makespan);
+    }
+}
+
+void HeuristicTable::read(std::istream & in)
+{
+    m_stateKey = ReadString(in);
+    m_keyTypes.clear();
+    m_maxCounts.clear();
+
+    const uint32_t numKeyTypes = ReadValue<uint32_t>(in);
+    BOSS_ASSERT(numKeyTypes <= MaxKeyTypes, "Heuristic table has too many key types: %d", (int)numKeyTypes);
+
+    size_t size = 1;
+    for (uint32_t k(0); k < numKeyTypes; ++k)
+    {
+        m_keyTypes.push_back(ActionType(ReadString(in)));
+        m_maxCounts.push_back(ReadValue<uint32_t>(in));
+        size *= m_maxCounts.back() + 1;
+    }
+
+    const uint32_t numMakespans = ReadValue<uint32_t>(in);
+    BOSS_ASSERT(numMakespans == size, "Heuristic table has %d makespans, expected %d", (int)numMakespans, (int)size);
+
+    m_makespans.resize(numMakespans);
+    for (int & makespan : m_makespans)
+    {
+        makespan = ReadValue<int32_t>(in);
+    }
+
+    calculateRequiredKeys();
+}
+
+HeuristicTable HeuristicTables::Build(const GameState & state, const std::vector<std::pair<ActionType, size_t>> & keyTypes, const int timeLimitMS)
+{
+    // more depots or workers than the exact search allows could make units, or new depots themselves, sooner than the table says
+    for (const auto & keyType : keyTypes)
+    {
+        const ActionType & type = keyType.first;
+        BOSS_ASSERT(type.isBuilding() && (!type.isDepot() || type.whatBuilds().isDepot()), "Heuristic table key types must be buildings that don't add a depot: %s", type.getName().c_str());
+    }
+
+    HeuristicTable table(state, keyTypes);
+
+    for (size_t i(0); i < table.size(); ++i)
+    {
+        const BuildOrderSearchGoal goal = table.getGoal(i);
+        if (!goal.hasGoal())
+        {
+            table.setMakespan(i, state.getCurrentFrame());
+            continue;
+        }
+
+        DFBB_BuildOrderSearchParameters params = GetExactSearchParameters(state, goal);
+        params.m_searchTimeLimit = timeLimitMS;
+
+        DFBB_BuildOrderStackSearch search(params);
+        search.search();
+
+        // the search starts with the naive makespan plus one as its upper bound, so if it found nothing better the naive build order is optimal
+        const DFBB_BuildOrderSearchResults & results = search.getResults();
+        if (results.solved)
+        {
+            table.setMakespan(i, results.solutionFound ? results.upperBound : results.upperBound - 1);
+        }
+        else
+        {
+            // the resource and builder bounds depend on the goal max a search sets for workers, so only the landmark bound is safe here
+            table.setMakespan(i, state.getCurrentFrame() + LowerBoundEvaluator(goal, true, false, false).getLowerBound(state));
+        }
+    }
+
+    return table;
+}
+
+void HeuristicTables::Add(const HeuristicTable & table)
+{
+    Tables[table.getStateKey()] = table;
+}
+
+void HeuristicTables::Clear()
+{
+    Tables.clear();
+}
+
+void HeuristicTables::Load(const std::string & filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open())
+    {
+        return;
+    }
+
+    char magic[sizeof(FileMagic)];
+    in.read(magic, sizeof(magic));
+    BOSS_ASSERT(in.good() && std::equal(magic, magic + sizeof(magic), FileMagic), "Not a heuristic table file: %s", filename.c_str());
+    BOSS_ASSERT(ReadValue<uint32_t>(in) == FileVersion, "Unsupported heuristic table file version: %s", filename.c_str());
+
+    const uint32_t numTables = ReadValue<uint32_t>(in);
+    for (uint32_t t(0); t < numTables; ++t)
+    {
+        HeuristicTable table;
+        table.read(in);
+        Add(table);
+    }
+}
+
+void HeuristicTables::Save(const std::string & filename)
+{
+    std::ofstream out(filename, std::ios::binary);
+    BOSS_ASSERT(out.is_open(), "Couldn't open heuristic table file for writing: %s", filename.c_str());
+
+    out.write(FileMagic, sizeof(FileMagic));
+    WriteValue<uint32_t>(out, FileVersion);
+    WriteValue<uint32_t>(out, (uint32_t)Tables.size());
+    for (const auto & entry : Tables)
+    {
+        entry.second.write(out);
+    }
+}
+
+int HeuristicTables::GetLowerBound(const GameState & state, const BuildOrderSearchGoal & goal)
+{
+    if (Tables.empty())
+    {
+        return 0;
+    }
+
+    const auto it = Tables.find(state.getNameKey());
+    if (it == Tables.end())
+    {
+        return 0;
+    }
+
+    const HeuristicTable & table = it->second;
+    return table.getMakespan(table.getIndex(goal));
+}
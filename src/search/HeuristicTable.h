@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Common.h"
+#include "ActionType.h"
+#include "GameState.h"
+#include "BuildOrderSearchGoal.h"
+
+namespace BOSS
+{
+
+// optimal makespans from one starting state for every goal made of a few key building types, such as tech buildings, up to a count each
+// any goal for that state is projected onto the key types it needs, and the makespan of that projection is a lower bound for it
+class HeuristicTable
+{
+    std::string             m_stateKey;
+    std::vector<ActionType> m_keyTypes;
+    std::vector<size_t>     m_maxCounts;
+    std::vector<int>        m_makespans;        // indexed by the key type counts, the first key type varying fastest
+    std::vector<uint32_t>   m_requiredKeys;     // indexed by ActionType ID, bit k set if making the type needs key type k first
+
+    void calculateRequiredKeys();
+
+public:
+
+    static const size_t MaxKeyTypes = 32;
+
+    HeuristicTable();
+    HeuristicTable(const GameState & state, const std::vector<std::pair<ActionType, size_t>> & keyTypes);
+
+    const std::string &     getStateKey() const;
+    size_t                  size() const;
+    size_t                  getIndex(const BuildOrderSearchGoal & goal) const;
+    BuildOrderSearchGoal    getGoal(const size_t index) const;
+    int                     getMakespan(const size_t index) const;
+    void                    setMakespan(const size_t index, const int makespan);
+
+    void                    write(std::ostream & out) const;
+    void                    read(std::istream & in);
+};
+
+// the tables loaded at BOSS::Init, looked up by the name key of the state a search starts from
+namespace HeuristicTables
+{
+    // searches every key type combination from the state with an exact DFBB search, giving each search timeLimitMS
+    // key types must be buildings, and a depot only if it's morphed from one like a Lair, see GetExactSearchParameters
+    // a search that times out stores the landmark lower bound instead
+    HeuristicTable  Build(const GameState & state, const std::vector<std::pair<ActionType, size_t>> & keyTypes, const int timeLimitMS);
+
+    void            Add(const HeuristicTable & table);
+    void            Clear();
+
+    // a missing file loads no tables
+    void            Load(const std::string & filename);
+    void            Save(const std::string & filename);
+
+    // the earliest frame the goal can be finished on from this state, or 0 if there is no table for the state
+    int             GetLowerBound(const GameState & state, const BuildOrderSearchGoal & goal);
+}
+
+}
@@ -0,0 +1,391 @@
+#include "LowerBoundEvaluator.h"
+#include "HeuristicTable.h"
+
+#include <cmath>
+
+using namespace BOSS;
+
+namespace
+{
+    // a chain ending in a type with no prerequisites, which Tools::GetLowerBound counts as zero
+    const int NoChain = std::numeric_limits<int>::min();
+    const size_t NotAdded = std::numeric_limits<size_t>::max();
+    const size_t Adding = NotAdded - 1;
+
+    // how often a hatchery spawns a larva, as in Unit::fastForward
+    const int LarvaSpawnFrames = 13 * 24;
+
+    // the number of units of this type or any type equivalent to it, as BuildOrderSearchGoal::isAchievedBy counts them
+    size_t GetNumEquivalent(const GameState & state, const ActionType & type)
+    {
+        size_t num = state.getNumTotal(type);
+        for (const ActionType & equivalent : type.equivalent())
+        {
+            num += state.getNumTotal(equivalent);
+        }
+
+        return num;
+    }
+
+    // the earliest time this much work can be done by builders which become free at the sorted freeTimes
+    int GetParallelFinishTime(const InlineVector<int, 16> & freeTimes, const int work)
+    {
+        double capacity = 0;
+        for (size_t b(0); b < freeTimes.size(); ++b)
+        {
+            const double numFree = (double)(b + 1);
+            if (b + 1 < freeTimes.size())
+            {
+                const double nextCapacity = capacity + numFree * (freeTimes[b + 1] - freeTimes[b]);
+                if (nextCapacity < work)
+                {
+                    capacity = nextCapacity;
+                    continue;
+                }
+            }
+
+            return freeTimes[b] + (int)std::ceil((work - capacity) / numFree);
+        }
+
+        return 0;
+    }
+}
+
+LowerBoundEvaluator::LowerBoundEvaluator()
+{
+
+}
+
+LowerBoundEvaluator::LowerBoundEvaluator(const BuildOrderSearchGoal & goal, bool useLandmark, bool useResource, bool useBuilder)
+    : m_goal(goal)
+    , m_useLandmark(useLandmark)
+    , m_useResource(useResource)
+    , m_useBuilder(useBuilder)
+{
+    std::vector<size_t> nodeIndex(ActionTypes::GetAllActionTypes().size(), NotAdded);
+
+    for (const ActionType & type : ActionTypes::GetAllActionTypes())
+    {
+        if (goal.getGoal(type) > 0)
+        {
+            GoalType goalType;
+            goalType.type = type;
+            goalType.count = goal.getGoal(type);
+            goalType.node = addNode(type, nodeIndex);
+            m_goalTypes.push_back(goalType);
+        }
+    }
+
+    for (size_t n(0); n < m_nodes.size(); ++n)
+    {
+        const ActionType builder = m_nodes[n].type.whatBuilds();
+        if (builder == ActionTypes::None || !builder.isBuilding())
+        {
+            continue;
+        }
+
+        auto group = std::find_if(m_builderGroups.begin(), m_builderGroups.end(), [&builder](const BuilderGroup & g) { return g.builder == builder; });
+        if (group == m_builderGroups.end())
+        {
+            m_builderGroups.push_back(BuilderGroup{ builder, {} });
+            group = m_builderGroups.end() - 1;
+        }
+
+        group->nodes.push_back(n);
+    }
+}
+
+// adds the type after all of its prerequisites, returning its index
+size_t LowerBoundEvaluator::addNode(const ActionType & type, std::vector<size_t> & nodeIndex)
+{
+    BOSS_ASSERT(nodeIndex[type.getID()] != Adding, "Prerequisite cycle through %s", type.getName().c_str());
+    if (nodeIndex[type.getID()] != NotAdded)
+    {
+        return nodeIndex[type.getID()];
+    }
+
+    nodeIndex[type.getID()] = Adding;
+
+    Node node;
+    node.type = type;
+    node.buildTime = type.buildTime();
+    node.mineralPrice = type.mineralPrice();
+    node.gasPrice = type.gasPrice();
+    const ActionSet & prerequisites = type.getPrerequisiteActionCount();
+    for (size_t p(0); p < prerequisites.size(); ++p)
+    {
+        node.prerequisites.push_back(addNode(prerequisites[p], nodeIndex));
+    }
+
+    nodeIndex[type.getID()] = m_nodes.size();
+    m_nodes.push_back(node);
+    return m_nodes.size() - 1;
+}
+
+void LowerBoundEvaluator::setRootState(const GameState & state)
+{
+    m_tableFinishFrame = HeuristicTables::GetLowerBound(state, m_goal);
+}
+
+int LowerBoundEvaluator::getTableFinishFrame() const
+{
+    return m_tableFinishFrame;
+}
+
+int LowerBoundEvaluator::getLowerBound(const GameState & state) const
+{
+    int lowerBound = std::max(0, m_tableFinishFrame - state.getCurrentFrame());
+    if (m_useLandmark)
+    {
+        lowerBound = std::max(lowerBound, getLandmarkLowerBound(state));
+    }
+
+    if (m_useResource || m_useBuilder)
+    {
+        size_t numNeeded[BOSS_MAX_ACTION_TYPES];
+        getNumNeeded(state, numNeeded);
+
+        if (m_useResource)
+        {
+            lowerBound = std::max(lowerBound, getResourceLowerBound(state, numNeeded));
+        }
+
+        if (m_useBuilder)
+        {
+            lowerBound = std::max(lowerBound, getBuilderLowerBound(state, numNeeded));
+        }
+    }
+
+    return lowerBound;
+}
+
+int LowerBoundEvaluator::getLandmarkLowerBound(const GameState & state) const
+{
+    // the time from now until each node's type could be completed, following its longest prerequisite chain
+    int chainTime[BOSS_MAX_ACTION_TYPES];
+
+    for (size_t n(0); n < m_nodes.size(); ++n)
+    {
+        const Node & node = m_nodes[n];
+
+        if (state.getNumCompleted(node.type) > 0)
+        {
+            chainTime[n] = 0;
+        }
+        else if (state.getNumInProgress(node.type) > 0)
+        {
+            chainTime[n] = state.getNextFinishTime(node.type) - state.getCurrentFrame();
+        }
+        else
+        {
+            int longest = NoChain;
+            for (const size_t p : node.prerequisites)
+            {
+                longest = std::max(longest, chainTime[p]);
+            }
+
+            chainTime[n] = (longest == NoChain) ? NoChain : longest + node.buildTime;
+        }
+    }
+
+    int lowerBound = 0;
+    for (const GoalType & goalType : m_goalTypes)
+    {
+        if (goalType.count > state.getNumTotal(goalType.type))
+        {
+            lowerBound = std::max(lowerBound, chainTime[goalType.node]);
+        }
+    }
+
+    return lowerBound;
+}
+
+// how many times each node's type still has to be made: enough for the goal's shortfall, or once for a missing prerequisite
+void LowerBoundEvaluator::getNumNeeded(const GameState & state, size_t numNeeded[]) const
+{
+    std::fill(numNeeded, numNeeded + m_nodes.size(), 0);
+    for (const GoalType & goalType : m_goalTypes)
+    {
+        const size_t have = GetNumEquivalent(state, goalType.type);
+        if (goalType.count > have)
+        {
+            numNeeded[goalType.node] = goalType.count - have;
+        }
+    }
+
+    // dependents come after their prerequisites, so walking backward sees every dependent of a node before it
+    for (size_t n(m_nodes.size()); n-- > 0;)
+    {
+        if (numNeeded[n] == 0)
+        {
+            continue;
+        }
+
+        for (const size_t p : m_nodes[n].prerequisites)
+        {
+            if (GetNumEquivalent(state, m_nodes[p].type) == 0)
+            {
+                numNeeded[p] = std::max(numNeeded[p], (size_t)1);
+            }
+        }
+    }
+}
+
+int LowerBoundEvaluator::getResourceLowerBound(const GameState & state) const
+{
+    size_t numNeeded[BOSS_MAX_ACTION_TYPES];
+    getNumNeeded(state, numNeeded);
+    return getResourceLowerBound(state, numNeeded);
+}
+
+int LowerBoundEvaluator::getResourceLowerBound(const GameState & state, const size_t numNeeded[]) const
+{
+    double mineralsNeeded = 0;
+    double gasNeeded = 0;
+    int shortestBuildTime = std::numeric_limits<int>::max();
+    for (size_t n(0); n < m_nodes.size(); ++n)
+    {
+        if (numNeeded[n] > 0)
+        {
+            mineralsNeeded += (double)numNeeded[n] * m_nodes[n].mineralPrice;
+            gasNeeded += (double)numNeeded[n] * m_nodes[n].gasPrice;
+            shortestBuildTime = std::min(shortestBuildTime, m_nodes[n].buildTime);
+        }
+    }
+
+    if (shortestBuildTime == std::numeric_limits<int>::max())
+    {
+        return 0;
+    }
+
+    // one more unit of each resource covers the fraction getMinerals and getGas round off
+    mineralsNeeded = std::max(0.0, mineralsNeeded - state.getMinerals() - 1);
+    gasNeeded = std::max(0.0, gasNeeded - state.getGas() - 1);
+
+    // gathering gas means having a refinery
+    const ActionType refinery = ActionTypes::GetRefinery(state.getRace());
+    if (gasNeeded > 0 && GetNumEquivalent(state, refinery) == 0)
+    {
+        mineralsNeeded += refinery.mineralPrice();
+        shortestBuildTime = std::min(shortestBuildTime, refinery.buildTime());
+    }
+
+    // a worker gathers either minerals or gas each frame
+    const double workerFrames = mineralsNeeded / state.getMineralsPerWorkerFrame() + gasNeeded / state.getGasPerWorkerFrame();
+    if (workerFrames <= 0)
+    {
+        return shortestBuildTime;
+    }
+
+    const double gatherTime = getWorkerFramesLowerBound(state, workerFrames);
+    if (gatherTime < 0)
+    {
+        return 0;
+    }
+
+    return (int)std::floor(gatherTime) + shortestBuildTime;
+}
+
+int LowerBoundEvaluator::getBuilderLowerBound(const GameState & state) const
+{
+    size_t numNeeded[BOSS_MAX_ACTION_TYPES];
+    getNumNeeded(state, numNeeded);
+    return getBuilderLowerBound(state, numNeeded);
+}
+
+int LowerBoundEvaluator::getBuilderLowerBound(const GameState & state, const size_t numNeeded[]) const
+{
+    int lowerBound = 0;
+    for (const BuilderGroup & group : m_builderGroups)
+    {
+        int work = 0;
+        int longestBuildTime = 0;
+        size_t numActions = 0;
+        for (const size_t n : group.nodes)
+        {
+            if (numNeeded[n] > 0)
+            {
+                work += (int)numNeeded[n] * m_nodes[n].buildTime;
+                longestBuildTime = std::max(longestBuildTime, m_nodes[n].buildTime);
+                numActions += numNeeded[n];
+            }
+        }
+
+        if (numActions == 0)
+        {
+            continue;
+        }
+
+        InlineVector<int, 16> freeTimes;
+        for (const Unit & unit : state.getUnits())
+        {
+            if (group.builder.equivalentMask().test(unit.getType().getID()))
+            {
+                freeTimes.push_back(unit.getTimeUntilFree());
+            }
+        }
+
+        // more builders can't be ready before one could be built, and more than one per action won't help
+        const size_t maxBuilders = getProductionLimit(state, group.builder);
+        for (size_t b(freeTimes.size()); b < maxBuilders && b < numActions; ++b)
+        {
+            freeTimes.push_back(group.builder.buildTime());
+        }
+
+        if (freeTimes.empty())
+        {
+            continue;
+        }
+
+        std::sort(freeTimes.begin(), freeTimes.end());
+        const int finishTime = std::max(GetParallelFinishTime(freeTimes, work), freeTimes[0] + longestBuildTime);
+        lowerBound = std::max(lowerBound, finishTime);
+    }
+
+    return lowerBound;
+}
+
+// the most units of this type the search can ever have, given the goal
+size_t LowerBoundEvaluator::getProductionLimit(const GameState & state, const ActionType & type) const
+{
+    return std::max(GetNumEquivalent(state, type), std::max(m_goal.getGoal(type), m_goal.getGoalMax(type)));
+}
+
+// the fewest frames in which the workers can put in this many worker frames of gathering, or -1 if they never can
+// each resource depot is assumed to add a worker as often as it possibly could, up to the goal's worker limit
+double LowerBoundEvaluator::getWorkerFramesLowerBound(const GameState & state, const double workerFrames) const
+{
+    const ActionType worker = ActionTypes::GetWorker(state.getRace());
+    const ActionType larva = ActionTypes::GetLarva(state.getRace());
+    const bool morphedFromLarva = (larva != ActionTypes::None) && (worker.whatBuilds() == larva);
+
+    const double maxWorkers = (double)getProductionLimit(state, worker);
+    double workers = (double)state.getNumTotal(worker);
+    double workerRate = 0;
+    if (maxWorkers > workers)
+    {
+        // every larva on hand could become a worker right away
+        if (morphedFromLarva)
+        {
+            workers = std::min(maxWorkers, workers + state.getNumTotal(larva));
+        }
+
+        const double depots = (double)getProductionLimit(state, ActionTypes::GetResourceDepot(state.getRace()));
+        workerRate = depots / (morphedFromLarva ? LarvaSpawnFrames : worker.buildTime());
+    }
+
+    if (workerRate <= 0 || workers >= maxWorkers)
+    {
+        return workers > 0 ? workerFrames / workers : -1;
+    }
+
+    // workers grow linearly until they reach the limit, then stay there
+    const double growthTime = (maxWorkers - workers) / workerRate;
+    const double growthFrames = workers * growthTime + workerRate * growthTime * growthTime / 2;
+    if (workerFrames > growthFrames)
+    {
+        return growthTime + (workerFrames - growthFrames) / maxWorkers;
+    }
+
+    return (std::sqrt(workers * workers + 2 * workerRate * workerFrames) - workers) / workerRate;
+}
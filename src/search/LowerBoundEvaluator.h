@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Common.h"
+#include "ActionType.h"
+#include "GameState.h"
+#include "BuildOrderSearchGoal.h"
+
+namespace BOSS
+{
+
+// the search heuristics for one fixed goal, built once per search
+// the goal's types and their recursive prerequisites are laid out so every type comes after its prerequisites,
+// which turns the recursive tree walks into a single pass over that list per evaluation
+class LowerBoundEvaluator
+{
+    struct Node
+    {
+        ActionType          type;
+        int                 buildTime = 0;
+        int                 mineralPrice = 0;
+        int                 gasPrice = 0;
+        std::vector<size_t> prerequisites;      // indices of earlier nodes
+    };
+
+    struct GoalType
+    {
+        ActionType          type;
+        size_t              count = 0;
+        size_t              node = 0;
+    };
+
+    // the nodes whose type is made by a building, which can only make one thing at a time
+    struct BuilderGroup
+    {
+        ActionType          builder;
+        std::vector<size_t> nodes;
+    };
+
+    BuildOrderSearchGoal        m_goal;
+    std::vector<Node>           m_nodes;
+    std::vector<GoalType>       m_goalTypes;
+    std::vector<BuilderGroup>   m_builderGroups;
+    bool                        m_useLandmark = true;
+    bool                        m_useResource = true;
+    bool                        m_useBuilder = true;
+    int                         m_tableFinishFrame = 0;
+
+    size_t addNode(const ActionType & type, std::vector<size_t> & nodeIndex);
+    void   getNumNeeded(const GameState & state, size_t numNeeded[]) const;
+    int    getResourceLowerBound(const GameState & state, const size_t numNeeded[]) const;
+    int    getBuilderLowerBound(const GameState & state, const size_t numNeeded[]) const;
+    size_t getProductionLimit(const GameState & state, const ActionType & type) const;
+    double getWorkerFramesLowerBound(const GameState & state, const double workerFrames) const;
+
+public:
+
+    LowerBoundEvaluator();
+    LowerBoundEvaluator(const BuildOrderSearchGoal & goal, bool useLandmark = true, bool useResource = true, bool useBuilder = true);
+
+    // looks up the goal's finish frame in the heuristic table for the state the search starts from, if one was loaded,
+    // which bounds every state the search reaches from it
+    void setRootState(const GameState & state);
+
+    // the frame from that table, or 0 if there wasn't one
+    int getTableFinishFrame() const;
+
+    // the max of the enabled lower bounds on the frames from now until the goal can be finished
+    int getLowerBound(const GameState & state) const;
+
+    // the length of the longest chain of prerequisites still needed for the goal, same as Tools::GetLowerBound
+    int getLandmarkLowerBound(const GameState & state) const;
+
+    // the time to gather what the goal and its missing prerequisites still cost, plus the shortest of their build times
+    // assumes resource depots and workers can't be made past the goal and goal max, as the searches enforce
+    int getResourceLowerBound(const GameState & state) const;
+
+    // the time for the buildings that make the goal and its missing prerequisites to build them all, one at a time each,
+    // starting when each building is next free and counting buildings the goal and goal max allow as free once built
+    int getBuilderLowerBound(const GameState & state) const;
+};
+
+}
@@ -3,31 +3,17 @@
 #include "Tools.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <limits>
+#include <thread>
 
 using namespace BOSS;
 
-MonteCarloTreeSearch::Node::Node()
-    : parent(-1)
-    , actionsGenerated(false)
-    , visits(0)
-    , totalReward(0.0)
-{
-}
-
-MonteCarloTreeSearch::Node::Node(const GameState & s, const BuildOrder & bo, int parentIndex)
-    : state(s)
-    , buildOrder(bo)
-    , parent(parentIndex)
-    , actionsGenerated(false)
-    , visits(0)
-    , totalReward(0.0)
-{
-}
-
 MonteCarloTreeSearch::MonteCarloTreeSearch()
-    : m_searchTimeLimitMS(30000)
+    : m_deadline(std::make_shared<Deadline>())
+    , m_treeMutex(nullptr)
+    , m_searchTimeLimitMS(30000)
     , m_iterationLimit(0)
     , m_explorationConstant(0.5)
     , m_printNewBest(false)
@@ -35,9 +21,16 @@ MonteCarloTreeSearch::MonteCarloTreeSearch()
     , m_useIncreasingRepetitions(true)
     , m_useLandmarkLowerBound(true)
     , m_useResourceLowerBound(true)
+    , m_useBuilderLowerBound(true)
     , m_useAlwaysMakeWorkers(true)
     , m_useSupplyBounding(true)
     , m_supplyBoundingThreshold(1.5)
+    , m_numThreads(1)
+    , m_useTreeParallelism(false)
+    , m_shuffleActions(false)
+    , m_rolloutPolicy(RolloutPolicyType::Naive)
+    , m_useTranspositions(false)
+    , m_rootEstimate(1)
 {
 }
 
@@ -51,9 +44,14 @@ void MonteCarloTreeSearch::setUseRepetitions(bool val)                        {
 void MonteCarloTreeSearch::setUseIncreasingRepetitions(bool val)              { m_useIncreasingRepetitions = val; }
 void MonteCarloTreeSearch::setUseLandmarkLowerBound(bool val)                 { m_useLandmarkLowerBound = val; }
 void MonteCarloTreeSearch::setUseResourceLowerBound(bool val)                 { m_useResourceLowerBound = val; }
+void MonteCarloTreeSearch::setUseBuilderLowerBound(bool val)                  { m_useBuilderLowerBound = val; }
 void MonteCarloTreeSearch::setUseAlwaysMakeWorkers(bool val)                  { m_useAlwaysMakeWorkers = val; }
 void MonteCarloTreeSearch::setUseSupplyBounding(bool val)                     { m_useSupplyBounding = val; }
 void MonteCarloTreeSearch::setSupplyBoundingThreshold(double val)             { m_supplyBoundingThreshold = val; }
+void MonteCarloTreeSearch::setNumThreads(size_t numThreads)                   { m_numThreads = std::max(numThreads, (size_t)1); }
+void MonteCarloTreeSearch::setUseTreeParallelism(bool val)                    { m_useTreeParallelism = val; }
+void MonteCarloTreeSearch::setRolloutPolicy(RolloutPolicyType policy)         { m_rolloutPolicy = policy; }
+void MonteCarloTreeSearch::setUseTranspositions(bool val)                     { m_useTranspositions = val; }
 
 void MonteCarloTreeSearch::search()
 {
@@ -61,24 +59,74 @@ void MonteCarloTreeSearch::search()
     BOSS_ASSERT(m_goal.hasGoal(), "Must set goal before MCTS search");
 
     m_searchTimer.start();
+    m_deadline->start(m_searchTimeLimitMS);
     calculateSearchSettings();
+    m_lowerBound = LowerBoundEvaluator(m_goal, m_useLandmarkLowerBound, m_useResourceLowerBound, m_useBuilderLowerBound);
+    m_lowerBound.setRootState(m_initialState);
 
     m_nodes.clear();
+    m_nodeStates.clear();
+    m_transpositions.clear();
     m_results = DFBB_BuildOrderSearchResults();
 
-    m_nodes.push_back(Node(m_initialState, BuildOrder(), -1));
+    // the root is always revisited, so its state is stored up front
+    Node root;
+    root.stateIndex = static_cast<uint32_t>(m_nodeStates.add(m_initialState));
+    root.expanded = true;
+    m_nodes.add(root);
 
-    int finishTime = 0;
-    BuildOrder buildOrder;
-    GameState finalState;
-    if (evaluateNode(0, finishTime, buildOrder, finalState))
+    if (m_useTranspositions)
+    {
+        m_transpositions[m_initialState.hash()] = 0;
+    }
+
+    m_rootEstimate = std::max(1, m_initialState.getCurrentFrame() + m_lowerBound.getLowerBound(m_initialState));
+
+    Rollout rollout;
+    evaluateState(m_initialState, std::numeric_limits<int>::max(), m_random, rollout);
+    if (rollout.solved)
+    {
+        updateBestSolution(0, rollout);
+    }
+
+    if (rollout.solved || rollout.estimated)
+    {
+        backpropagate({ 0 }, 1.0);
+    }
+
+    if (m_numThreads > 1 && m_useTreeParallelism)
+    {
+        searchTreeParallel();
+    }
+    else if (m_numThreads > 1)
+    {
+        searchRootParallel();
+    }
+    else
     {
-        updateBestSolution(finishTime, buildOrder, finalState);
-        backpropagate(0, 1.0, finishTime);
+        runIterations();
     }
 
+    m_deadline->stop();
+    m_results.solved = m_results.solutionFound;
+    m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+}
+
+// the select / expand / evaluate / backpropagate loop, which every thread of a tree parallel search runs on the same tree
+void MonteCarloTreeSearch::runIterations()
+{
+    // every thread plays out with its own generator, since rollouts run without the tree lock
+    std::mt19937 random;
+    {
+        std::unique_lock<std::mutex> lock = lockTree();
+        random.seed(m_random());
+    }
+
+    std::vector<uint32_t> path;
     while (true)
     {
+        std::unique_lock<std::mutex> lock = lockTree();
+
         if (isTimeOut())
         {
             m_results.timedOut = true;
@@ -90,91 +138,242 @@ void MonteCarloTreeSearch::search()
             break;
         }
 
-        const size_t selectedNode = selectNode();
-        int nodeFinishTime = 0;
-        BuildOrder nodeBuildOrder;
-        GameState nodeFinalState;
-        double reward = 0.0;
-
-        if (evaluateNode(selectedNode, nodeFinishTime, nodeBuildOrder, nodeFinalState))
+        if (isTreeExhausted())
         {
-            updateBestSolution(nodeFinishTime, nodeBuildOrder, nodeFinalState);
-            const int baseline = std::max(1, m_results.upperBound);
-            reward = static_cast<double>(baseline) / static_cast<double>(std::max(1, nodeFinishTime));
+            break;
         }
 
-        backpropagate(selectedNode, reward, nodeFinishTime);
+        GameState state;
+        const size_t selectedNode = selectNode(state, path);
+        const int upperBound = m_results.solutionFound ? m_results.upperBound : std::numeric_limits<int>::max();
         m_results.nodesExpanded++;
 
-        if (m_nodes.size() == 1 && m_nodes.front().actionsGenerated && m_nodes.front().untriedActions.empty() && m_nodes.front().children.empty())
+        // the rollout is most of the work, so other threads can use the tree while it runs
+        if (lock.owns_lock())
         {
-            break;
+            lock.unlock();
         }
+
+        Rollout rollout;
+        evaluateState(state, upperBound, random, rollout);
+
+        if (m_treeMutex)
+        {
+            lock.lock();
+        }
+
+        if (rollout.solved)
+        {
+            updateBestSolution(selectedNode, rollout);
+        }
+
+        backpropagate(path, getReward(rollout));
     }
+}
 
-    m_results.solved = m_results.solutionFound;
-    m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
+std::unique_lock<std::mutex> MonteCarloTreeSearch::lockTree()
+{
+    return m_treeMutex ? std::unique_lock<std::mutex>(*m_treeMutex) : std::unique_lock<std::mutex>();
 }
 
-size_t MonteCarloTreeSearch::selectNode()
+bool MonteCarloTreeSearch::isTreeExhausted() const
+{
+    const Node & root = m_nodes[0];
+    return root.actionsGenerated && root.untriedActions == 0 && root.numExpandedChildren == 0;
+}
+
+// root parallelism: every thread grows its own tree, in a different order, and the best solution of any of them is kept
+void MonteCarloTreeSearch::searchRootParallel()
+{
+    std::vector<std::unique_ptr<MonteCarloTreeSearch>> trees;
+    for (size_t t(0); t < m_numThreads; ++t)
+    {
+        trees.push_back(std::make_unique<MonteCarloTreeSearch>(*this));
+        trees[t]->m_random.seed(static_cast<unsigned int>(t));
+        trees[t]->m_shuffleActions = t > 0;
+        trees[t]->m_iterationLimit = (m_iterationLimit + m_numThreads - 1) / m_numThreads;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t t(0); t < m_numThreads; ++t)
+    {
+        threads.emplace_back(&MonteCarloTreeSearch::runIterations, trees[t].get());
+    }
+
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+
+    // merge the root statistics and results of every tree into the first one
+    m_nodes = std::move(trees[0]->m_nodes);
+    m_nodeStates = std::move(trees[0]->m_nodeStates);
+    m_results = trees[0]->m_results;
+    for (size_t t(1); t < m_numThreads; ++t)
+    {
+        const MonteCarloTreeSearch & tree = *trees[t];
+        m_nodes[0].visits       += tree.m_nodes[0].visits;
+        m_nodes[0].totalReward  += tree.m_nodes[0].totalReward;
+        m_results.nodesExpanded += tree.m_results.nodesExpanded;
+        m_results.timedOut      |= tree.m_results.timedOut;
+
+        if (tree.m_results.solutionFound && (!m_results.solutionFound || tree.m_results.upperBound < m_results.upperBound))
+        {
+            m_results.upperBound    = tree.m_results.upperBound;
+            m_results.solutionFound = true;
+            m_results.buildOrder    = tree.m_results.buildOrder;
+            m_results.finalState    = tree.m_results.finalState;
+            m_results.timeElapsed   = tree.m_results.timeElapsed;
+        }
+    }
+}
+
+// tree parallelism: every thread works on the same tree, a virtual loss on the nodes a thread is
+// evaluating steers the others elsewhere until the real result is backpropagated
+void MonteCarloTreeSearch::searchTreeParallel()
+{
+    std::mutex treeMutex;
+    m_treeMutex = &treeMutex;
+
+    std::vector<std::thread> threads;
+    for (size_t t(0); t < m_numThreads; ++t)
+    {
+        threads.emplace_back(&MonteCarloTreeSearch::runIterations, this);
+    }
+
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+
+    m_treeMutex = nullptr;
+}
+
+// walks down the tree to the node to evaluate next, copies its state into leafState and
+// records the nodes on the way in path, which is what gets backpropagated once the tree is a DAG
+size_t MonteCarloTreeSearch::selectNode(GameState & leafState, std::vector<uint32_t> & path)
 {
     size_t nodeIndex = 0;
+    const GameState * state = &m_nodeStates[m_nodes[0].stateIndex];
+    path.clear();
 
     while (true)
     {
-        if (m_goal.isAchievedBy(m_nodes[nodeIndex].state))
+        path.push_back(static_cast<uint32_t>(nodeIndex));
+
+        // virtual loss: count the visit now with no reward, backpropagate only adds the reward
+        if (m_treeMutex)
         {
-            return nodeIndex;
+            m_nodes[nodeIndex].visits++;
+        }
+
+        if (m_goal.isAchievedBy(*state))
+        {
+            break;
         }
 
         if (!m_nodes[nodeIndex].actionsGenerated)
         {
-            generateLegalActions(m_nodes[nodeIndex].state, m_nodes[nodeIndex].untriedActions);
-            m_nodes[nodeIndex].actionsGenerated = true;
+            generateChildren(nodeIndex, *state);
         }
 
-        if (!m_nodes[nodeIndex].untriedActions.empty())
+        if (m_nodes[nodeIndex].untriedActions)
         {
-            return expandNode(nodeIndex);
+            const size_t childIndex = expandNode(nodeIndex, *state, leafState);
+            if (childIndex == nodeIndex)
+            {
+                break;
+            }
+
+            // the child is a state already in the tree, so there's nothing new to evaluate and selection carries on from it
+            const size_t transposition = m_nodes[childIndex].transposition;
+            if (transposition != NoIndex)
+            {
+                nodeIndex = transposition;
+                state = &m_nodeStates[m_nodes[nodeIndex].stateIndex];
+                continue;
+            }
+
+            if (m_treeMutex)
+            {
+                m_nodes[childIndex].visits++;
+            }
+
+            path.push_back(static_cast<uint32_t>(childIndex));
+            return childIndex;
         }
 
-        if (m_nodes[nodeIndex].children.empty())
+        if (m_nodes[nodeIndex].numExpandedChildren == 0)
         {
-            return nodeIndex;
+            break;
         }
 
         nodeIndex = bestUCTChild(nodeIndex);
+        state = &getNodeState(nodeIndex, *state);
+    }
+
+    leafState = *state;
+    return nodeIndex;
+}
+
+// gives every legal action a child slot, all next to each other in the arena, tried later one at a time by expandNode
+void MonteCarloTreeSearch::generateChildren(const size_t nodeIndex, const GameState & state)
+{
+    generateLegalActions(state, m_legalActions);
+    BOSS_ASSERT(m_legalActions.size() <= 64, "MCTS nodes can have at most 64 legal actions, got %zu", m_legalActions.size());
+
+    if (m_shuffleActions)
+    {
+        std::shuffle(m_legalActions.begin(), m_legalActions.end(), m_random);
+    }
+
+    Node & node = m_nodes[nodeIndex];
+    node.actionsGenerated = true;
+    node.numChildren = static_cast<uint16_t>(m_legalActions.size());
+    node.untriedActions = m_legalActions.empty() ? 0 : (~0ull >> (64 - m_legalActions.size()));
+    node.firstChild = static_cast<uint32_t>(m_nodes.size());
+
+    Node child;
+    child.parent = static_cast<uint32_t>(nodeIndex);
+    for (const ActionType & actionType : m_legalActions)
+    {
+        child.action = actionType;
+        m_nodes.add(child);
     }
 }
 
-size_t MonteCarloTreeSearch::expandNode(const size_t nodeIndex)
+// tries the untried children of a node, last one first, until one is legal and not pruned
+// returns that child with its state in childState, or the node itself if every child got pruned
+size_t MonteCarloTreeSearch::expandNode(const size_t nodeIndex, const GameState & state, GameState & childState)
 {
     Node & node = m_nodes[nodeIndex];
+    const int heuristicTime = getHeuristicTime(state);
 
-    while (!node.untriedActions.empty())
+    while (node.untriedActions)
     {
-        const ActionType actionType = node.untriedActions.back();
-        node.untriedActions.pop_back();
+        const size_t childSlot = 63 - std::countl_zero(node.untriedActions);
+        node.untriedActions &= ~(1ull << childSlot);
+
+        const size_t childIndex = node.firstChild + childSlot;
+        Node & child = m_nodes[childIndex];
 
-        if (shouldPruneAction(node.state, actionType))
+        if (shouldPruneAction(state, child.action, heuristicTime))
         {
             continue;
         }
 
-        GameState childState(node.state);
-        BuildOrder childBuildOrder(node.buildOrder);
-        const size_t repetitions = getRepetitions(childState, actionType);
+        childState = state;
+        const size_t repetitions = getRepetitions(childState, child.action);
         size_t completedRepetitions = 0;
 
         for (; completedRepetitions < repetitions; ++completedRepetitions)
         {
-            if (!childState.isLegal(actionType))
+            if (!childState.isLegal(child.action))
             {
                 break;
             }
 
-            childBuildOrder.add(actionType);
-            childState.doAction(actionType);
+            childState.doAction(child.action);
         }
 
         if (completedRepetitions == 0)
@@ -182,25 +381,94 @@ size_t MonteCarloTreeSearch::expandNode(const size_t nodeIndex)
             continue;
         }
 
-        const size_t childIndex = m_nodes.size();
-        m_nodes.push_back(Node(childState, childBuildOrder, static_cast<int>(nodeIndex)));
-        m_nodes[nodeIndex].children.push_back(childIndex);
+        child.repetitions = static_cast<uint16_t>(completedRepetitions);
+        child.expanded = true;
+        node.numExpandedChildren++;
+
+        if (m_useTranspositions)
+        {
+            child.transposition = static_cast<uint32_t>(findTransposition(childIndex, childState));
+        }
+
         return childIndex;
     }
 
     return nodeIndex;
 }
 
+// looks up a newly expanded child's state, returns the node first reached with it or NoIndex if the state is new
+// a transposed node gets the state stored here, since it can now be reached from a parent it wasn't built from
+size_t MonteCarloTreeSearch::findTransposition(const size_t childIndex, const GameState & childState)
+{
+    const auto inserted = m_transpositions.emplace(childState.hash(), static_cast<uint32_t>(childIndex));
+    if (inserted.second)
+    {
+        return NoIndex;
+    }
+
+    Node & transposition = m_nodes[inserted.first->second];
+    if (transposition.stateIndex == NoIndex)
+    {
+        transposition.stateIndex = static_cast<uint32_t>(m_nodeStates.add(childState));
+    }
+
+    return inserted.first->second;
+}
+
+// the state of a node selection is passing through, which is stored the first time since it is being revisited
+const GameState & MonteCarloTreeSearch::getNodeState(const size_t nodeIndex, const GameState & parentState)
+{
+    Node & node = m_nodes[nodeIndex];
+    if (node.stateIndex == NoIndex)
+    {
+        GameState state(parentState);
+        for (size_t r(0); r < node.repetitions; ++r)
+        {
+            state.doAction(node.action);
+        }
+
+        node.stateIndex = static_cast<uint32_t>(m_nodeStates.add(state));
+    }
+
+    return m_nodeStates[node.stateIndex];
+}
+
+BuildOrder MonteCarloTreeSearch::getBuildOrder(size_t nodeIndex) const
+{
+    std::vector<ActionType> reversed;
+    for (; nodeIndex != 0; nodeIndex = m_nodes[nodeIndex].parent)
+    {
+        const Node & node = m_nodes[nodeIndex];
+        reversed.insert(reversed.end(), node.repetitions, node.action);
+    }
+
+    BuildOrder buildOrder;
+    for (auto it = reversed.rbegin(); it != reversed.rend(); ++it)
+    {
+        buildOrder.add(*it);
+    }
+
+    return buildOrder;
+}
+
 size_t MonteCarloTreeSearch::bestUCTChild(const size_t nodeIndex) const
 {
     const Node & node = m_nodes[nodeIndex];
     const double parentVisits = std::max<size_t>(1, node.visits);
     double bestScore = -std::numeric_limits<double>::infinity();
-    size_t bestChild = node.children.front();
+    size_t bestChild = nodeIndex;
 
-    for (const size_t childIndex : node.children)
+    for (size_t slot(node.firstChild); slot < node.firstChild + node.numChildren; ++slot)
     {
+        if (!m_nodes[slot].expanded)
+        {
+            continue;
+        }
+
+        // a transposed child shares the statistics of the node it stands in for
+        const size_t childIndex = m_nodes[slot].transposition == NoIndex ? slot : m_nodes[slot].transposition;
         const Node & child = m_nodes[childIndex];
+
         if (child.visits == 0)
         {
             return childIndex;
@@ -220,65 +488,117 @@ size_t MonteCarloTreeSearch::bestUCTChild(const size_t nodeIndex) const
     return bestChild;
 }
 
-bool MonteCarloTreeSearch::evaluateNode(const size_t nodeIndex, int & finishTime, BuildOrder & buildOrder, GameState & finalState)
+void MonteCarloTreeSearch::evaluateState(const GameState & state, const int upperBound, std::mt19937 & random, Rollout & rollout)
 {
-    const Node & node = m_nodes[nodeIndex];
+    if (m_goal.isAchievedBy(state))
+    {
+        rollout.solved = true;
+        rollout.finishTime = state.getLastActionFinishTime();
+        rollout.finalState = state;
+        return;
+    }
 
-    if (m_goal.isAchievedBy(node.state))
+    switch (m_rolloutPolicy)
     {
-        finishTime = node.state.getLastActionFinishTime();
-        buildOrder = node.buildOrder;
-        finalState = node.state;
-        return true;
+        case RolloutPolicyType::RandomPlayout:  rolloutRandomPlayout(state, upperBound, random, rollout); break;
+        case RolloutPolicyType::Heuristic:      evaluateHeuristic(state, rollout); break;
+        default:                                rolloutNaive(state, rollout); break;
     }
+}
 
-    NaiveBuildOrderSearch naiveSearch(node.state, m_goal);
-    const BuildOrder & suffix = naiveSearch.solve();
-    if (suffix.empty())
+// solves the rest of the goal with the naive build order search and simulates it to get the finish time
+void MonteCarloTreeSearch::rolloutNaive(const GameState & state, Rollout & rollout)
+{
+    NaiveBuildOrderSearch naiveSearch(state, m_goal);
+    rollout.suffix = naiveSearch.solve();
+    if (rollout.suffix.empty())
     {
-        return false;
+        return;
     }
 
-    finalState = node.state;
-    for (size_t i(0); i < suffix.size(); ++i)
+    rollout.finalState = state;
+    for (size_t i(0); i < rollout.suffix.size(); ++i)
     {
-        if (!finalState.isLegal(suffix[i]))
+        if (!rollout.finalState.isLegal(rollout.suffix[i]))
         {
-            return false;
+            return;
         }
 
-        finalState.doAction(suffix[i]);
+        rollout.finalState.doAction(rollout.suffix[i]);
     }
 
-    if (!m_goal.isAchievedBy(finalState))
+    if (!m_goal.isAchievedBy(rollout.finalState))
     {
-        return false;
+        return;
     }
 
-    buildOrder = node.buildOrder;
-    buildOrder.add(suffix);
-    finishTime = finalState.getLastActionFinishTime();
-    return true;
+    rollout.solved = true;
+    rollout.finishTime = rollout.finalState.getLastActionFinishTime();
 }
 
-void MonteCarloTreeSearch::backpropagate(size_t nodeIndex, const double reward, const int finishTime)
+// plays uniformly random actions from the tree's legal action generator until the goal is met
+void MonteCarloTreeSearch::rolloutRandomPlayout(const GameState & state, const int upperBound, std::mt19937 & random, Rollout & rollout)
 {
-    while (true)
+    std::vector<ActionType> legalActions;
+    rollout.finalState = state;
+
+    while (!m_goal.isAchievedBy(rollout.finalState))
     {
-        Node & node = m_nodes[nodeIndex];
-        node.visits++;
-        node.totalReward += reward;
-        if (node.parent < 0)
+        // nothing done from here can finish before the current frame, so the playout can't beat the best solution
+        if (rollout.finalState.getCurrentFrame() >= upperBound)
         {
-            break;
+            return;
         }
 
-        nodeIndex = static_cast<size_t>(node.parent);
+        generateLegalActions(rollout.finalState, legalActions);
+        if (legalActions.empty())
+        {
+            return;
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, legalActions.size() - 1);
+        const ActionType actionType = legalActions[pick(random)];
+        rollout.suffix.add(actionType);
+        rollout.finalState.doAction(actionType);
+    }
+
+    rollout.solved = true;
+    rollout.finishTime = rollout.finalState.getLastActionFinishTime();
+}
+
+// no simulation, the leaf is scored by the lower bound on when it can finish the goal
+void MonteCarloTreeSearch::evaluateHeuristic(const GameState & state, Rollout & rollout)
+{
+    rollout.estimated = true;
+    rollout.finishTime = state.getCurrentFrame() + m_lowerBound.getLowerBound(state);
+}
+
+// the baseline finish time over the rollout's, the baseline being the best solution so far or the root's lower bound before there is one
+double MonteCarloTreeSearch::getReward(const Rollout & rollout) const
+{
+    if (!rollout.solved && !rollout.estimated)
+    {
+        return 0.0;
     }
+
+    const int baseline = m_results.solutionFound ? std::max(1, m_results.upperBound) : m_rootEstimate;
+    return static_cast<double>(baseline) / static_cast<double>(std::max(1, rollout.finishTime));
 }
 
-void MonteCarloTreeSearch::updateBestSolution(const int finishTime, const BuildOrder & buildOrder, const GameState & finalState)
+void MonteCarloTreeSearch::backpropagate(const std::vector<uint32_t> & path, const double reward)
 {
+    for (const uint32_t nodeIndex : path)
+    {
+        Node & node = m_nodes[nodeIndex];
+        node.visits += m_treeMutex ? 0 : 1;     // a tree parallel search already counted the visit as a virtual loss
+        node.totalReward += reward;
+    }
+}
+
+// the build order is only put together from the tree when the solution is an improvement
+void MonteCarloTreeSearch::updateBestSolution(const size_t nodeIndex, const Rollout & rollout)
+{
+    const int finishTime = rollout.finishTime;
     if (finishTime <= 0)
     {
         return;
@@ -286,10 +606,13 @@ void MonteCarloTreeSearch::updateBestSolution(const int finishTime, const BuildO
 
     if (!m_results.solutionFound || finishTime < m_results.upperBound)
     {
+        BuildOrder buildOrder = getBuildOrder(nodeIndex);
+        buildOrder.add(rollout.suffix);
+
         m_results.upperBound = finishTime;
         m_results.solutionFound = true;
         m_results.buildOrder = buildOrder;
-        m_results.finalState = finalState;
+        m_results.finalState = rollout.finalState;
         m_results.timeElapsed = m_searchTimer.getElapsedTimeInMilliSec();
 
         if (m_printNewBest)
@@ -376,24 +699,24 @@ void MonteCarloTreeSearch::generateLegalActions(const GameState & state, std::ve
     std::reverse(legalActions.begin(), legalActions.end());
 }
 
-bool MonteCarloTreeSearch::shouldPruneAction(const GameState & state, const ActionType & actionType) const
+// heuristicTime is getHeuristicTime of the state, which is the same for all of its actions
+bool MonteCarloTreeSearch::shouldPruneAction(const GameState & state, const ActionType & actionType, const int heuristicTime) const
 {
     if (!m_results.solutionFound)
     {
         return false;
     }
 
-    int maxHeuristic = state.whenCanBuild(actionType) + actionType.buildTime();
-
-    if (m_useLandmarkLowerBound || m_useResourceLowerBound)
-    {
-        const int heuristicTime = state.getCurrentFrame() + Tools::GetLowerBound(state, m_goal);
-        maxHeuristic = std::max(maxHeuristic, heuristicTime);
-    }
-
+    const int maxHeuristic = std::max(state.whenCanBuild(actionType) + actionType.buildTime(), heuristicTime);
     return maxHeuristic > m_results.upperBound;
 }
 
+// the earliest frame the goal can be finished from this state by the enabled heuristics
+int MonteCarloTreeSearch::getHeuristicTime(const GameState & state) const
+{
+    return state.getCurrentFrame() + m_lowerBound.getLowerBound(state);
+}
+
 size_t MonteCarloTreeSearch::getRepetitions(const GameState & state, const ActionType & actionType)
 {
     size_t repeat = m_useRepetitions ? m_params.getRepetitions(actionType) : 1;
@@ -423,7 +746,7 @@ size_t MonteCarloTreeSearch::getRepetitions(const GameState & state, const Actio
 
 bool MonteCarloTreeSearch::isTimeOut()
 {
-    return m_searchTimeLimitMS > 0 && m_searchTimer.getElapsedTimeInMilliSec() > m_searchTimeLimitMS;
+    return m_deadline->expired();
 }
 
 void MonteCarloTreeSearch::calculateSearchSettings()
@@ -459,6 +782,7 @@ void MonteCarloTreeSearch::calculateSearchSettings()
     m_params.m_useIncreasingRepetitions = m_useIncreasingRepetitions;
     m_params.m_useLandmarkLowerBoundHeuristic = m_useLandmarkLowerBound;
     m_params.m_useResourceLowerBoundHeuristic = m_useResourceLowerBound;
+    m_params.m_useBuilderLowerBoundHeuristic = m_useBuilderLowerBound;
     m_params.m_useAlwaysMakeWorkers = m_useAlwaysMakeWorkers;
     m_params.m_useSupplyBounding = m_useSupplyBounding;
     m_params.m_supplyBoundingThreshold = m_supplyBoundingThreshold;
@@ -8,33 +8,65 @@
 #include "DFBB_BuildOrderSearchResults.h"
 #include "GameState.h"
 #include "Timer.hpp"
+#include "Deadline.hpp"
+#include "NodeArena.hpp"
+#include "RolloutPolicy.hpp"
+#include "LowerBoundEvaluator.h"
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
 
 namespace BOSS
 {
 
 class MonteCarloTreeSearch
 {
+    static const uint32_t NoIndex = std::numeric_limits<uint32_t>::max();
+
+    // a node only stores how it was reached from its parent, its state is rebuilt from the
+    // parent's state when selection first passes through it and is kept from then on
     struct Node
     {
-        GameState               state;
-        BuildOrder              buildOrder;
-        std::vector<size_t>     children;
-        std::vector<ActionType> untriedActions;
-        int                     parent;
-        bool                    actionsGenerated;
-        size_t                  visits;
-        double                  totalReward;
-
-        Node();
-        Node(const GameState & s, const BuildOrder & bo, int parentIndex);
+        uint32_t    parent              = NoIndex;
+        uint32_t    firstChild          = NoIndex;  // the children are [firstChild, firstChild + numChildren), one per legal action
+        uint32_t    stateIndex          = NoIndex;  // index in m_nodeStates, NoIndex until the node is revisited
+        uint32_t    transposition       = NoIndex;  // an earlier node with the same state, which this child stands in for
+        uint16_t    numChildren         = 0;
+        uint16_t    numExpandedChildren = 0;
+        uint64_t    untriedActions      = 0;        // bit i is set until child i has been tried
+        ActionType  action;                         // done repetitions times to the parent's state to reach this node
+        uint16_t    repetitions         = 0;
+        bool        actionsGenerated    = false;
+        bool        expanded            = false;    // tried and legal, pruned children are never selected
+        size_t      visits              = 0;
+        double      totalReward         = 0.0;
+    };
+
+    // what the rollout policy found from a leaf, either a solution or only an estimate of when the goal can be finished
+    struct Rollout
+    {
+        bool        solved      = false;
+        bool        estimated   = false;
+        int         finishTime  = 0;
+        BuildOrder  suffix;                 // the build order from the leaf state to the goal, if solved
+        GameState   finalState;
     };
 
     BuildOrderSearchGoal                m_goal;
+    LowerBoundEvaluator                 m_lowerBound;           // the enabled lower bound heuristics for m_goal, used by all threads
     GameState                           m_initialState;
     DFBB_BuildOrderSearchParameters     m_params;
     DFBB_BuildOrderSearchResults        m_results;
     Timer                               m_searchTimer;
-    std::vector<Node>                   m_nodes;
+    std::shared_ptr<Deadline>           m_deadline;         // shared with the threads of a parallel search
+    NodeArena<Node>                     m_nodes;
+    NodeArena<GameState, 6>             m_nodeStates;       // states of the revisited nodes, a GameState is large so the chunks are small
+    std::vector<ActionType>             m_legalActions;
+    std::unordered_map<uint64_t, uint32_t> m_transpositions; // state hash to the node first reached with that state
+    std::mutex *                        m_treeMutex;        // guards the tree and m_results while threads share one tree, nullptr otherwise
+    std::mt19937                        m_random;
 
     int                                 m_searchTimeLimitMS;
     size_t                              m_iterationLimit;
@@ -44,9 +76,16 @@ class MonteCarloTreeSearch
     bool                                m_useIncreasingRepetitions;
     bool                                m_useLandmarkLowerBound;
     bool                                m_useResourceLowerBound;
+    bool                                m_useBuilderLowerBound;
     bool                                m_useAlwaysMakeWorkers;
     bool                                m_useSupplyBounding;
     double                              m_supplyBoundingThreshold;
+    size_t                              m_numThreads;
+    bool                                m_useTreeParallelism;   // threads share one tree instead of searching a tree each
+    bool                                m_shuffleActions;       // expand children in a random order, so root parallel trees differ
+    RolloutPolicyType                   m_rolloutPolicy;
+    bool                                m_useTranspositions;    // share nodes between action orders reaching the same state, making the tree a DAG
+    int                                 m_rootEstimate;         // lower bound on the finish time from the root, the reward baseline until a solution is found
 
     void calculateSearchSettings();
     void setPrerequisiteGoalMax();
@@ -56,16 +95,30 @@ class MonteCarloTreeSearch
 
     size_t calculateSupplyProvidersRequired();
     size_t calculateRefineriesRequired();
-    size_t selectNode();
-    size_t expandNode(const size_t nodeIndex);
+    size_t selectNode(GameState & leafState, std::vector<uint32_t> & path);
+    size_t expandNode(const size_t nodeIndex, const GameState & state, GameState & childState);
+    void generateChildren(const size_t nodeIndex, const GameState & state);
+    const GameState & getNodeState(const size_t nodeIndex, const GameState & parentState);
+    BuildOrder getBuildOrder(size_t nodeIndex) const;
     size_t bestUCTChild(const size_t nodeIndex) const;
+    size_t findTransposition(const size_t childIndex, const GameState & childState);
     size_t getRepetitions(const GameState & state, const ActionType & actionType);
     bool isTimeOut();
-    bool shouldPruneAction(const GameState & state, const ActionType & actionType) const;
-    bool evaluateNode(const size_t nodeIndex, int & finishTime, BuildOrder & buildOrder, GameState & finalState);
+    bool shouldPruneAction(const GameState & state, const ActionType & actionType, const int heuristicTime) const;
+    int getHeuristicTime(const GameState & state) const;
+    void evaluateState(const GameState & state, const int upperBound, std::mt19937 & random, Rollout & rollout);
+    void rolloutNaive(const GameState & state, Rollout & rollout);
+    void rolloutRandomPlayout(const GameState & state, const int upperBound, std::mt19937 & random, Rollout & rollout);
+    void evaluateHeuristic(const GameState & state, Rollout & rollout);
+    double getReward(const Rollout & rollout) const;
+    bool isTreeExhausted() const;
+    void runIterations();
+    void searchRootParallel();
+    void searchTreeParallel();
+    std::unique_lock<std::mutex> lockTree();
     void generateLegalActions(const GameState & state, std::vector<ActionType> & legalActions);
-    void backpropagate(size_t nodeIndex, const double reward, const int finishTime);
-    void updateBestSolution(const int finishTime, const BuildOrder & buildOrder, const GameState & finalState);
+    void backpropagate(const std::vector<uint32_t> & path, const double reward);
+    void updateBestSolution(const size_t nodeIndex, const Rollout & rollout);
 
     const RaceID getRace() const;
 
@@ -82,9 +135,14 @@ public:
     void setUseIncreasingRepetitions(bool val);
     void setUseLandmarkLowerBound(bool val);
     void setUseResourceLowerBound(bool val);
+    void setUseBuilderLowerBound(bool val);
     void setUseAlwaysMakeWorkers(bool val);
     void setUseSupplyBounding(bool val);
     void setSupplyBoundingThreshold(double val);
+    void setNumThreads(size_t numThreads);
+    void setUseTreeParallelism(bool val);
+    void setRolloutPolicy(RolloutPolicyType policy);
+    void setUseTranspositions(bool val);
 
     void search();
 
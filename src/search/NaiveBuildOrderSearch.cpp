@@ -98,7 +98,7 @@ const BuildOrder & NaiveBuildOrderSearch::solve()
     // if we are zerg, make sure we have enough morphers for morphed units
     if (m_state.getRace() == Races::Zerg)
     {
-        static const ActionType & Larva = ActionTypes::GetActionType("Larva");
+        const ActionType Larva = ActionTypes::GetLarva(m_state.getRace());
 
         // do this whole thing twice so that Hive->Lair->Hatchery is satisfied
         for (size_t t=0; t<2; ++t)
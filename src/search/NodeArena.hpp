@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Common.h"
+
+#include <memory>
+
+namespace BOSS
+{
+
+// append-only storage for search tree nodes, allocated in fixed size chunks
+// growing it never moves existing elements, so indices and references to them stay valid,
+// and elements added one after another get consecutive indices
+template <class T, size_t ChunkBits = 12>
+class NodeArena
+{
+    static const size_t ChunkSize = size_t(1) << ChunkBits;
+
+    std::vector<std::unique_ptr<T[]>>   m_chunks;
+    size_t                              m_size = 0;
+
+public:
+
+    NodeArena() {}
+
+    NodeArena(const NodeArena & other)
+    {
+        *this = other;
+    }
+
+    NodeArena & operator = (const NodeArena & other)
+    {
+        if (this != &other)
+        {
+            clear();
+            for (size_t i(0); i < other.size(); ++i)
+            {
+                add(other[i]);
+            }
+        }
+
+        return *this;
+    }
+
+    NodeArena(NodeArena && other) = default;
+    NodeArena & operator = (NodeArena && other) = default;
+
+    // returns the index of the new element
+    size_t add(const T & value)
+    {
+        if (m_size == m_chunks.size() * ChunkSize)
+        {
+            m_chunks.emplace_back(new T[ChunkSize]);
+        }
+
+        (*this)[m_size] = value;
+        return m_size++;
+    }
+
+    T & operator [] (const size_t i)
+    {
+        return m_chunks[i >> ChunkBits][i & (ChunkSize - 1)];
+    }
+
+    const T & operator [] (const size_t i) const
+    {
+        return m_chunks[i >> ChunkBits][i & (ChunkSize - 1)];
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    // keeps the allocated chunks so the next search can reuse them
+    void clear()
+    {
+        m_size = 0;
+    }
+};
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Common.h"
+
+namespace BOSS
+{
+
+// how MonteCarloTreeSearch evaluates a leaf, from slowest and most accurate to fastest
+enum class RolloutPolicyType
+{
+    Naive,          // solve the rest of the goal with NaiveBuildOrderSearch and simulate it
+    RandomPlayout,  // play random legal actions until the goal is met, giving up once past the best solution
+    Heuristic       // no simulation, estimate the finish time with the enabled lower bounds
+};
+
+namespace RolloutPolicy
+{
+
+inline std::string GetPolicyName(RolloutPolicyType policy)
+{
+    switch (policy)
+    {
+        case RolloutPolicyType::RandomPlayout:  return "RandomPlayout";
+        case RolloutPolicyType::Heuristic:      return "Heuristic";
+        default:                                return "Naive";
+    }
+}
+
+inline RolloutPolicyType GetPolicyType(const std::string & name)
+{
+    if (name == "Naive")         return RolloutPolicyType::Naive;
+    if (name == "RandomPlayout") return RolloutPolicyType::RandomPlayout;
+    if (name == "Heuristic")     return RolloutPolicyType::Heuristic;
+    BOSS_ASSERT(false, "Unknown rollout policy type: %s", name.c_str());
+    return RolloutPolicyType::Naive;
+}
+
+}
+
+}
@@ -0,0 +1,49 @@
+#include "TranspositionTable.h"
+
+using namespace BOSS;
+
+// the size is rounded up to a power of two so a slot can be found with a mask
+TranspositionTable::TranspositionTable(size_t size)
+{
+    size_t powerOfTwo = 1;
+    while (powerOfTwo < size) { powerOfTwo <<= 1; }
+
+    m_entries = std::make_unique<Entry[]>(powerOfTwo);
+    m_mask = powerOfTwo - 1;
+}
+
+bool TranspositionTable::lookup(const uint64_t key, int & finishTime) const
+{
+    const Entry & entry = m_entries[key & m_mask];
+    const uint64_t data = entry.data.load(std::memory_order_relaxed);
+    if ((entry.check.load(std::memory_order_relaxed) ^ data) != key || data == 0)
+    {
+        return false;
+    }
+
+    finishTime = static_cast<int>(data - 1);
+    return true;
+}
+
+void TranspositionTable::store(const uint64_t key, const int finishTime)
+{
+    // the stored data is offset by one so an empty slot never matches a real entry
+    const uint64_t data = static_cast<uint64_t>(finishTime) + 1;
+    Entry & entry = m_entries[key & m_mask];
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i(0); i <= m_mask; ++i)
+    {
+        m_entries[i].check.store(0, std::memory_order_relaxed);
+        m_entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t TranspositionTable::size() const
+{
+    return m_mask + 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace BOSS
+{
+
+// Fixed size table mapping a GameState hash to the best finish time seen for that state.
+// Each slot holds the key xor'd with its data, so a slot written by two threads at once simply
+// fails to match on lookup rather than returning a mixed up value. No locks are ever taken.
+class TranspositionTable
+{
+    struct Entry
+    {
+        std::atomic<uint64_t> check { 0 };   // key ^ data
+        std::atomic<uint64_t> data  { 0 };
+    };
+
+    std::unique_ptr<Entry[]>    m_entries;
+    size_t                      m_mask = 0;
+
+public:
+
+    TranspositionTable(size_t size);
+
+    bool    lookup(const uint64_t key, int & finishTime) const;
+    void    store(const uint64_t key, const int finishTime);
+    void    clear();
+    size_t  size() const;
+};
+
+}
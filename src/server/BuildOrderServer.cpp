@@ -0,0 +1,449 @@
+#include "BuildOrderServer.h"
+
+#include "AStarBuildOrderSearch.h"
+#include "DFBB_BuildOrderSmartSearch.h"
+#include "JSONTools.h"
+#include "MonteCarloTreeSearch.h"
+#include "NaiveBuildOrderSearch.h"
+#include "Timer.hpp"
+#include "Tools.h"
+
+#include <memory>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+using namespace BOSS;
+
+namespace
+{
+    const size_t MaxUnitCount = 200;
+    const int    MaxSupply    = 400;    // supply is counted in halves, so this is 200 in game
+
+    // a type name from a [name, count] pair that exists and belongs to the race, or an error message
+    std::string ValidateTypeCount(const json & entry, const RaceID race, const char * listName)
+    {
+        if (!entry.is_array() || entry.size() != 2 || !entry[0].is_string() || !entry[1].is_number_integer())
+        {
+            return std::string(listName) + " entries must be [type name, count] arrays";
+        }
+
+        const std::string name = entry[0].get<std::string>();
+        if (!ActionTypes::TypeExists(name))
+        {
+            return "unknown action type: " + name;
+        }
+
+        const ActionType type = ActionTypes::GetActionType(name);
+        if (type.getRace() != race)
+        {
+            return name + " is not a " + Races::GetRaceName(race) + " type";
+        }
+
+        if (type == ActionTypes::GetLarva(race))
+        {
+            return "larva can't be listed in " + std::string(listName);
+        }
+
+        if (entry[1].get<int>() < 0 || entry[1].get<int>() > (int)MaxUnitCount)
+        {
+            return std::string(listName) + " counts must be between 0 and " + std::to_string(MaxUnitCount);
+        }
+
+        return "";
+    }
+
+    // replays the build order, which must be legal at every step, and checks that it ends with the goal made
+    bool ReachesGoal(const GameState & state, BuildOrderSearchGoal goal, const BuildOrder & buildOrder)
+    {
+        GameState finalState = state;
+        for (size_t i(0); i < buildOrder.size(); ++i)
+        {
+            if (!finalState.isLegal(buildOrder[i]))
+            {
+                return false;
+            }
+
+            finalState.doAction(buildOrder[i]);
+        }
+
+        return goal.isAchievedBy(finalState);
+    }
+}
+
+BuildOrderServer::BuildOrderServer(const size_t numThreads, const int defaultTimeLimitMS, const int maxTimeLimitMS)
+    : m_threadPool(numThreads)
+    , m_defaultTimeLimitMS(defaultTimeLimitMS)
+    , m_maxTimeLimitMS(maxTimeLimitMS)
+{
+
+}
+
+// checks everything JSONTools and the searches are known to assert on, since a bad request shouldn't stop the server
+std::string BuildOrderServer::validateRequest(const json & request) const
+{
+    if (!request.is_object())
+    {
+        return "request must be a JSON object";
+    }
+
+    if (!request.count("state") || !request["state"].is_object())
+    {
+        return "request must have a 'state' object";
+    }
+
+    const json & state = request["state"];
+    if (!state.count("units") || !state["units"].is_array() || state["units"].empty())
+    {
+        return "state must have a non-empty 'units' array";
+    }
+
+    if (!state["units"][0].is_array() || state["units"][0].empty() || !state["units"][0][0].is_string() || !ActionTypes::TypeExists(state["units"][0][0]))
+    {
+        return "state units must start with a [type name, count] array";
+    }
+
+    const RaceID race = ActionTypes::GetActionType(state["units"][0][0]).getRace();
+    if (state.count("race") && (!state["race"].is_string() || Races::GetRaceID(state["race"]) != race))
+    {
+        return "state race doesn't match its units";
+    }
+
+    bool hasWorker = false;
+    bool hasDepot = false;
+    int supplyUsed = 0;
+    int supplyProvided = 0;
+    for (const auto & unit : state["units"])
+    {
+        const std::string error = ValidateTypeCount(unit, race, "units");
+        if (!error.empty())
+        {
+            return error;
+        }
+
+        const ActionType type = ActionTypes::GetActionType(unit[0]);
+        if (!type.isUnit())
+        {
+            return "state units can't include " + type.getName();
+        }
+
+        hasWorker |= type.isWorker() && unit[1].get<int>() > 0;
+        hasDepot  |= type.isDepot() && unit[1].get<int>() > 0;
+        supplyUsed     += unit[1].get<int>() * type.supplyCost();
+        supplyProvided += unit[1].get<int>() * type.supplyProvided();
+    }
+
+    if (!hasWorker || !hasDepot)
+    {
+        return "state must have a worker and a resource depot";
+    }
+
+    if (supplyUsed > std::min(supplyProvided, MaxSupply))
+    {
+        return "state units use more supply than they provide";
+    }
+
+    for (const char * resource : { "minerals", "gas" })
+    {
+        if (state.count(resource) && (!state[resource].is_number_integer() || state[resource].get<int>() < 0))
+        {
+            return std::string("state ") + resource + " must be a non-negative int";
+        }
+    }
+
+    if (!request.count("goal") || !request["goal"].is_object())
+    {
+        return "request must have a 'goal' object";
+    }
+
+    const json & goal = request["goal"];
+    if (goal.count("race") && (!goal["race"].is_string() || Races::GetRaceID(goal["race"]) != race))
+    {
+        return "goal race doesn't match the state";
+    }
+
+    if (!goal.count("goal") || !goal["goal"].is_array())
+    {
+        return "goal must have a 'goal' array";
+    }
+
+    bool hasGoal = false;
+    for (const char * listName : { "goal", "goalMax" })
+    {
+        if (!goal.count(listName))
+        {
+            continue;
+        }
+
+        if (!goal[listName].is_array())
+        {
+            return std::string("goal '") + listName + "' must be an array";
+        }
+
+        for (const auto & entry : goal[listName])
+        {
+            const std::string error = ValidateTypeCount(entry, race, listName);
+            if (!error.empty())
+            {
+                return error;
+            }
+
+            // the naive build order, which every search falls back on, asserts on units morphed from other units
+            const ActionType type = ActionTypes::GetActionType(entry[0]);
+            const ActionType builder = type.whatBuilds();
+            if (type.whatBuildsCount() > 1 || (builder.isUnit() && !builder.isBuilding() && !builder.isWorker() && builder != ActionTypes::GetLarva(race)))
+            {
+                return type.getName() + " is morphed from another unit, which isn't supported";
+            }
+
+            hasGoal |= std::string(listName) == "goal" && entry[1].get<int>() > 0;
+        }
+    }
+
+    if (!hasGoal)
+    {
+        return "goal must ask for at least one unit";
+    }
+
+    if (request.count("search") && (!request["search"].is_string() || !std::set<std::string>({ "DFBB", "AStar", "MCTS", "Naive" }).count(request["search"])))
+    {
+        return "search must be one of DFBB, AStar, MCTS or Naive";
+    }
+
+    if (request.count("timeLimitMS") && (!request["timeLimitMS"].is_number_integer() || request["timeLimitMS"].get<int>() <= 0))
+    {
+        return "timeLimitMS must be a positive int";
+    }
+
+    return "";
+}
+
+DFBB_BuildOrderSearchResults BuildOrderServer::runSearch(const std::string & searchType, const GameState & state, const BuildOrderSearchGoal & goal, const int timeLimitMS) const
+{
+    DFBB_BuildOrderSearchResults results;
+
+    if (searchType == "DFBB")
+    {
+        DFBB_BuildOrderSmartSearch search;
+        search.setState(state);
+        search.setGoal(goal);
+        search.setTimeLimit(timeLimitMS);
+        search.search();
+        results = search.getResults();
+    }
+    else if (searchType == "AStar")
+    {
+        AStarBuildOrderSearch search;
+        search.setState(state);
+        search.setGoal(goal);
+        search.setTimeLimit(timeLimitMS);
+        search.search();
+        results = search.getResults();
+    }
+    else if (searchType == "MCTS")
+    {
+        MonteCarloTreeSearch search;
+        search.setState(state);
+        search.setGoal(goal);
+        search.setTimeLimit(timeLimitMS);
+        search.search();
+        results = search.getResults();
+    }
+
+    // the naive build order is the answer for a Naive request, and for a search that found nothing better than it
+    if (!results.solutionFound)
+    {
+        Timer timer;
+        timer.start();
+
+        NaiveBuildOrderSearch naiveSearch(state, goal);
+        results.buildOrder = naiveSearch.solve();
+        results.upperBound = Tools::GetBuildOrderCompletionTime(state, results.buildOrder);
+        results.solutionFound = true;
+        results.timeElapsed += timer.getElapsedTimeInMilliSec();
+    }
+
+    return results;
+}
+
+std::string BuildOrderServer::handleRequest(const std::string & line) const
+{
+    json result;
+
+    try
+    {
+        const json request = json::parse(line);
+        if (request.is_object() && request.count("id"))
+        {
+            result["id"] = request["id"];
+        }
+
+        const std::string error = validateRequest(request);
+        if (!error.empty())
+        {
+            result["error"] = error;
+            return result.dump();
+        }
+
+        const GameState state = JSONTools::GetGameState(request["state"]);
+
+        json goalVal = request["goal"];
+        goalVal["race"] = Races::GetRaceName(state.getRace());
+        const BuildOrderSearchGoal goal = JSONTools::GetBuildOrderSearchGoal(goalVal);
+
+        const std::string searchType = request.count("search") ? request["search"].get<std::string>() : "DFBB";
+        const int timeLimitMS = std::min(request.count("timeLimitMS") ? request["timeLimitMS"].get<int>() : m_defaultTimeLimitMS, m_maxTimeLimitMS);
+
+        const DFBB_BuildOrderSearchResults results = runSearch(searchType, state, goal, timeLimitMS);
+
+        // a search can report an empty or partial build order for a goal it can't reach, so only answer with one that reaches it
+        if (!ReachesGoal(state, goal, results.buildOrder))
+        {
+            result["error"] = "no build order reaches the goal from this state";
+            return result.dump();
+        }
+
+        std::vector<std::string> buildOrder;
+        for (size_t i(0); i < results.buildOrder.size(); ++i)
+        {
+            buildOrder.push_back(results.buildOrder[i].getName());
+        }
+
+        result["search"]        = searchType;
+        result["solved"]        = results.solved;
+        result["timedOut"]      = results.timedOut;
+        result["makespan"]      = results.upperBound;
+        result["nodesExpanded"] = results.nodesExpanded;
+        result["timeElapsed"]   = results.timeElapsed;
+        result["buildOrder"]    = buildOrder;
+    }
+    catch (const json::exception & e)
+    {
+        result["error"] = std::string("couldn't read request: ") + e.what();
+    }
+
+    return result.dump();
+}
+
+void BuildOrderServer::serve(std::istream & in, std::ostream & out)
+{
+    std::mutex outMutex;
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        m_threadPool.add([this, line, &out, &outMutex]()
+        {
+            const std::string result = handleRequest(line);
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            out << result << std::endl;
+        });
+    }
+
+    m_threadPool.wait();
+}
+
+#ifndef _WIN32
+
+namespace
+{
+    // closes the socket once the reader and every search answering it are done with it
+    struct Connection
+    {
+        int         fd;
+        std::mutex  writeMutex;
+
+        Connection(const int socket) : fd(socket) {}
+        ~Connection() { close(fd); }
+
+        void write(const std::string & line)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            const std::string data = line + "\n";
+            size_t sent = 0;
+            while (sent < data.size())
+            {
+                const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                {
+                    return;
+                }
+
+                sent += n;
+            }
+        }
+    };
+}
+
+void BuildOrderServer::serveSocket(const std::string & socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    BOSS_ASSERT(socketPath.size() < sizeof(address.sun_path), "Socket path is too long: %s", socketPath.c_str());
+    std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    BOSS_ASSERT(listener >= 0, "Couldn't create socket");
+
+    unlink(socketPath.c_str());
+    BOSS_ASSERT(bind(listener, (sockaddr *)&address, sizeof(address)) == 0, "Couldn't bind socket: %s", socketPath.c_str());
+    BOSS_ASSERT(listen(listener, 64) == 0, "Couldn't listen on socket: %s", socketPath.c_str());
+
+    while (true)
+    {
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+
+        // each connection gets a thread that only reads, the searches themselves share the pool
+        std::thread([this, client]()
+        {
+            auto connection = std::make_shared<Connection>(client);
+            std::string buffer;
+            char chunk[4096];
+
+            ssize_t n;
+            while ((n = recv(connection->fd, chunk, sizeof(chunk), 0)) > 0)
+            {
+                buffer.append(chunk, n);
+
+                size_t newline;
+                while ((newline = buffer.find('\n')) != std::string::npos)
+                {
+                    const std::string line = buffer.substr(0, newline);
+                    buffer.erase(0, newline + 1);
+
+                    if (line.find_first_not_of(" \t\r") == std::string::npos)
+                    {
+                        continue;
+                    }
+
+                    m_threadPool.add([this, line, connection]()
+                    {
+                        connection->write(handleRequest(line));
+                    });
+                }
+            }
+        }).detach();
+    }
+}
+
+#else
+
+void BuildOrderServer::serveSocket(const std::string & socketPath)
+{
+    BOSS_ASSERT(false, "Unix socket mode isn't supported on Windows, use stdin instead");
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Common.h"
+#include "GameState.h"
+#include "BuildOrderSearchGoal.h"
+#include "DFBB_BuildOrderSearchResults.h"
+#include "ThreadPool.hpp"
+
+#include <mutex>
+
+namespace BOSS
+{
+
+// answers build order search requests sent as one JSON object per line, running them concurrently on a thread pool
+// and writing one JSON result per line as each finishes, so results can come back in a different order than the requests
+//
+// request:  { "id" : 7, "state" : { "minerals" : 50, "gas" : 0, "units" : [ ["Probe", 4], ["Nexus", 1] ] },
+//             "goal" : { "goal" : [ ["Dragoon", 2] ], "goalMax" : [] }, "search" : "DFBB", "timeLimitMS" : 1000 }
+// result:   { "id" : 7, "solved" : true, "timedOut" : false, "makespan" : 4000, "nodesExpanded" : 1234,
+//             "timeElapsed" : 12.5, "buildOrder" : [ "Probe", ... ] }
+//
+// search is one of DFBB, AStar, MCTS or Naive, and a request that can't be read or whose goal can't be reached from its state
+// gets { "id" : 7, "error" : "..." }
+class BuildOrderServer
+{
+    ThreadPool  m_threadPool;
+    int         m_defaultTimeLimitMS;
+    int         m_maxTimeLimitMS;
+
+    DFBB_BuildOrderSearchResults runSearch(const std::string & searchType, const GameState & state, const BuildOrderSearchGoal & goal, const int timeLimitMS) const;
+
+public:
+
+    BuildOrderServer(const size_t numThreads, const int defaultTimeLimitMS, const int maxTimeLimitMS);
+
+    // the reason the request can't be searched, or an empty string if it can
+    std::string validateRequest(const json & request) const;
+
+    // runs one request line on the calling thread and returns its result line
+    std::string handleRequest(const std::string & line) const;
+
+    // reads requests until the end of the input and returns once every result has been written
+    void serve(std::istream & in, std::ostream & out);
+
+    // accepts connections on a Unix domain socket, each sending requests and getting its own results back, until the process ends
+    void serveSocket(const std::string & socketPath);
+};
+
+}
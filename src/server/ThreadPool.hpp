@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Common.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace BOSS
+{
+
+// a fixed set of worker threads running queued tasks in the order they were added
+class ThreadPool
+{
+    std::vector<std::thread>            m_threads;
+    std::deque<std::function<void()>>   m_tasks;
+    std::mutex                          m_mutex;
+    std::condition_variable             m_taskAdded;
+    std::condition_variable             m_taskFinished;
+    size_t                              m_running = 0;
+    bool                                m_stopping = false;
+
+    void work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_taskAdded.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                ++m_running;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_running;
+            }
+            m_taskFinished.notify_all();
+        }
+    }
+
+public:
+
+    ThreadPool(const size_t numThreads)
+    {
+        for (size_t t(0); t < std::max(numThreads, (size_t)1); ++t)
+        {
+            m_threads.emplace_back(&ThreadPool::work, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool & other) = delete;
+    ThreadPool & operator = (const ThreadPool & other) = delete;
+
+    // finishes every queued task before the threads exit
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_taskAdded.notify_all();
+
+        for (std::thread & thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    void add(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_taskAdded.notify_one();
+    }
+
+    // blocks until the queue is empty and no task is running
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_taskFinished.wait(lock, [this]() { return m_tasks.empty() && m_running == 0; });
+    }
+
+    size_t size() const
+    {
+        return m_threads.size();
+    }
+};
+
+}
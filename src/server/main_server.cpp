@@ -0,0 +1,61 @@
+#include "BOSS.h"
+#include "BuildOrderServer.h"
+
+#include <thread>
+
+using namespace BOSS;
+
+// BOSS_Server [--socket path] [--threads n] [--time-limit ms] [--max-time-limit ms]
+// without --socket, requests are read from stdin and results written to stdout until stdin closes
+int main(int argc, char *argv[])
+{
+    std::string socketPath;
+    size_t numThreads       = std::max(std::thread::hardware_concurrency(), 1u);
+    int defaultTimeLimitMS  = 1000;
+    int maxTimeLimitMS      = 60000;
+
+    for (int a(1); a < argc; ++a)
+    {
+        const std::string arg = argv[a];
+        const bool hasValue = a + 1 < argc;
+
+        if (arg == "--socket" && hasValue)
+        {
+            socketPath = argv[++a];
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            numThreads = std::stoul(argv[++a]);
+        }
+        else if (arg == "--time-limit" && hasValue)
+        {
+            defaultTimeLimitMS = std::stoi(argv[++a]);
+        }
+        else if (arg == "--max-time-limit" && hasValue)
+        {
+            maxTimeLimitMS = std::stoi(argv[++a]);
+        }
+        else
+        {
+            std::cerr << "Usage: BOSS_Server [--socket path] [--threads n] [--time-limit ms] [--max-time-limit ms]\n";
+            return 1;
+        }
+    }
+
+    // Initialize all the BOSS internal data once for every request
+    BOSS::Init("config/BWData.json", "config/BOSS_HeuristicTables.bin");
+
+    BuildOrderServer server(numThreads, defaultTimeLimitMS, maxTimeLimitMS);
+
+    if (socketPath.empty())
+    {
+        server.serve(std::cin, std::cout);
+    }
+    else
+    {
+        std::cerr << "BOSS_Server listening on " << socketPath << " with " << numThreads << " threads" << std::endl;
+        server.serveSocket(socketPath);
+    }
+
+    return 0;
+}
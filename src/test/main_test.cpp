@@ -2,7 +2,19 @@
 
 #include "BOSS.h"
 #include "ActionSet.h"
+#include "ActionTypeData.h"
+#include "Deadline.hpp"
 #include "search/BuildOrderSearchGoal.h"
+#include "search/TranspositionTable.h"
+#include "search/DFBB_BuildOrderSmartSearch.h"
+#include "search/AStarBuildOrderSearch.h"
+#include "search/BucketQueue.hpp"
+#include "search/MonteCarloTreeSearch.h"
+#include "search/NodeArena.hpp"
+#include "search/LowerBoundEvaluator.h"
+#include "search/NaiveBuildOrderSearch.h"
+#include "search/HeuristicTable.h"
+#include "server/BuildOrderServer.h"
 
 using namespace BOSS;
 
@@ -12,6 +24,8 @@ namespace BOSS
 {
 namespace Tools
 {
+    int  GetLowerBound(const GameState & state, const BuildOrderSearchGoal & goal);
+    int  GetUpperBound(const GameState & state, const BuildOrderSearchGoal & goal);
     int  GetBuildOrderCompletionTime(const GameState & state, const BuildOrder & buildOrder);
     void DoBuildOrder(GameState & state, const BuildOrder & buildOrder);
     void CalculatePrerequisitesRequiredToBuild(const GameState & state, const ActionSet & wanted, ActionSet & requiredToBuild);
@@ -713,6 +727,105 @@ TEST_CASE("Terran addon prerequisites are recursive prerequisites")
     REQUIRE(recursivePrerequisites.contains(ActionType("ScienceFacility")));
 }
 
+TEST_CASE("ActionType accessors match the data file for every action")
+{
+    BOSS::Init("config/BWData.json");
+
+    for (const ActionType & actionType : ActionTypes::GetAllActionTypes())
+    {
+        const ActionTypeData & data = ActionTypeData::GetActionTypeData(actionType.getID());
+        INFO(data.name);
+
+        REQUIRE(actionType.getRace() == static_cast<RaceID>(data.race));
+        REQUIRE(actionType.buildTime() == data.buildTime);
+        REQUIRE(actionType.mineralPrice() == data.mineralCost);
+        REQUIRE(actionType.gasPrice() == data.gasCost);
+        REQUIRE(actionType.supplyCost() == data.supplyCost);
+        REQUIRE(actionType.supplyProvided() == data.supplyProvided);
+        REQUIRE(actionType.buildLimit() == data.buildLimit);
+        REQUIRE(actionType.whatBuilds() == data.whatBuilds);
+        REQUIRE(actionType.whatBuildsAddon() == data.whatBuildsAddon);
+        REQUIRE(actionType.whatBuildsCount() == static_cast<int>(data.whatBuildsCount));
+        REQUIRE(actionType.isUnit() == data.isUnit);
+        REQUIRE(actionType.isUpgrade() == (data.isUpgrade || data.isTech));
+        REQUIRE(actionType.isBuilding() == data.isBuilding);
+        REQUIRE(actionType.isWorker() == data.isWorker);
+        REQUIRE(actionType.isRefinery() == data.isRefinery);
+        REQUIRE(actionType.isSupplyProvider() == data.isSupplyProvider);
+        REQUIRE(actionType.isDepot() == data.isDepot);
+        REQUIRE(actionType.isAddon() == data.isAddon);
+        REQUIRE(actionType.isHatchery() == data.isHatchery);
+        REQUIRE(actionType.isMorphed() == data.isMorphed);
+        REQUIRE(actionType.isTech() == data.isTech);
+    }
+}
+
+TEST_CASE("Race roles are resolved from the data file flags")
+{
+    BOSS::Init("config/BWData.json");
+
+    REQUIRE(ActionTypes::GetWorker(Races::Protoss).getName() == "Probe");
+    REQUIRE(ActionTypes::GetRefinery(Races::Protoss).getName() == "Assimilator");
+    REQUIRE(ActionTypes::GetSupplyProvider(Races::Protoss).getName() == "Pylon");
+    REQUIRE(ActionTypes::GetResourceDepot(Races::Protoss).getName() == "Nexus");
+    REQUIRE(ActionTypes::GetLarva(Races::Protoss) == ActionTypes::None);
+
+    REQUIRE(ActionTypes::GetWorker(Races::Terran).getName() == "SCV");
+    REQUIRE(ActionTypes::GetRefinery(Races::Terran).getName() == "Refinery");
+    REQUIRE(ActionTypes::GetSupplyProvider(Races::Terran).getName() == "SupplyDepot");
+    REQUIRE(ActionTypes::GetResourceDepot(Races::Terran).getName() == "CommandCenter");
+    REQUIRE(ActionTypes::GetHatchery(Races::Terran) == ActionTypes::None);
+
+    REQUIRE(ActionTypes::GetWorker(Races::Zerg).getName() == "Drone");
+    REQUIRE(ActionTypes::GetRefinery(Races::Zerg).getName() == "Extractor");
+    REQUIRE(ActionTypes::GetSupplyProvider(Races::Zerg).getName() == "Overlord");
+    REQUIRE(ActionTypes::GetResourceDepot(Races::Zerg).getName() == "Hatchery");
+    REQUIRE(ActionTypes::GetLarva(Races::Zerg).getName() == "Larva");
+    REQUIRE(ActionTypes::GetHatchery(Races::Zerg).getName() == "Hatchery");
+}
+
+TEST_CASE("ActionSet keeps insertion order through set algebra")
+{
+    BOSS::Init("config/BWData.json");
+
+    const ActionType probe("Probe"), pylon("Pylon"), gateway("Gateway"), zealot("Zealot");
+
+    ActionSet set;
+    set.add(gateway);
+    set.add(probe);
+    set.add(gateway);
+    REQUIRE(set.size() == 2);
+
+    ActionSet other;
+    other.add(zealot);
+    other.add(probe);
+    other.add(pylon);
+
+    set.add(other);
+    REQUIRE(set.size() == 4);
+    REQUIRE(set[0] == gateway);
+    REQUIRE(set[1] == probe);
+    REQUIRE(set[2] == zealot);
+    REQUIRE(set[3] == pylon);
+
+    ActionSet removed;
+    removed.add(probe);
+    removed.add(zealot);
+    set.remove(removed);
+    REQUIRE(set.size() == 2);
+    REQUIRE(set[0] == gateway);
+    REQUIRE(set[1] == pylon);
+    REQUIRE(!set.contains(probe));
+
+    set.remove(gateway);
+    REQUIRE(set.size() == 1);
+    REQUIRE(set[0] == pylon);
+
+    set.clear();
+    REQUIRE(set.isEmpty());
+    REQUIRE(!set.contains(pylon));
+}
+
 TEST_CASE("Battlecruiser requires a Starport ControlTower")
 {
     BOSS::Init("config/BWData.json");
@@ -1168,3 +1281,868 @@ TEST_CASE("Protoss opening legal action set contains expected baseline actions")
     REQUIRE(ContainsAction(legalActions, ActionType("Nexus")));
     REQUIRE_FALSE(ContainsAction(legalActions, ActionType("Zealot")));
 }
+
+TEST_CASE("Cached unit counts match the unit list")
+{
+    auto checkCounts = [](const GameState & state)
+    {
+        for (const ActionType & type : ActionTypes::GetAllActionTypes())
+        {
+            size_t total = 0, completed = 0, inProgress = 0;
+            for (const Unit & unit : state.getUnits())
+            {
+                if (unit.getType() != type) { continue; }
+                total++;
+                if (unit.getTimeUntilBuilt() == 0) { completed++; }
+                else { inProgress++; }
+            }
+
+            REQUIRE(state.getNumTotal(type) == total);
+            REQUIRE(state.getNumCompleted(type) == completed);
+            REQUIRE(state.getNumInProgress(type) <= inProgress);
+            REQUIRE(state.haveType(type) == (total > 0));
+        }
+    };
+
+    GameState zerg = MakeZergStartState();
+    for (const char * name : { "Drone", "Drone", "Overlord", "SpawningPool", "Drone", "Extractor", "Zergling", "Lair", "HydraliskDen", "Hydralisk", "LurkerAspect", "Hydralisk", "Lurker" })
+    {
+        zerg.doAction(ActionType(name));
+        checkCounts(zerg);
+    }
+    zerg.fastForward(zerg.getLastActionFinishTime());
+    checkCounts(zerg);
+
+    GameState protoss = MakeProtossStartState();
+    for (const char * name : { "Probe", "Pylon", "Probe", "Gateway", "Assimilator", "CyberneticsCore", "CitadelofAdun", "TemplarArchives", "HighTemplar", "HighTemplar", "Archon" })
+    {
+        protoss.doAction(ActionType(name));
+        checkCounts(protoss);
+    }
+    protoss.fastForward(protoss.getLastActionFinishTime());
+    checkCounts(protoss);
+}
+
+TEST_CASE("GameState inline storage stays small enough to keep one per search node")
+{
+    // A*, MCTS and the parallel DFBB tasks all store whole states, so the inline buffers are paid for per node
+    REQUIRE(sizeof(Unit) <= 48);
+    REQUIRE(sizeof(GameState) <= 3 * 1024);
+    REQUIRE(sizeof(UndoJournal) <= 1024);
+
+    // a start state and the first few actions fit inline
+    GameState state = MakeZergStartState();
+    REQUIRE(state.getUnits().isInline());
+}
+
+TEST_CASE("GameState copies past the inline unit capacity")
+{
+    GameState state = MakeProtossStartState();
+    state.setMinerals(1000000);
+    state.doAction(ActionType("Pylon"));
+    state.doAction(ActionType("Gateway"));
+
+    GameState small = state;
+    REQUIRE(small == state);
+    REQUIRE(small.getUnits().isInline());
+
+    while (state.getUnits().size() <= BOSS_INLINE_UNITS)
+    {
+        state.doAction(state.isLegal(ActionType("Zealot")) ? ActionType("Zealot") : ActionType("Pylon"));
+    }
+    REQUIRE_FALSE(state.getUnits().isInline());
+
+    GameState copy = state;
+    REQUIRE(copy == state);
+    REQUIRE(copy.getNumTotal(ActionType("Zealot")) == state.getNumTotal(ActionType("Zealot")));
+
+    // assigning a large state over a small one and back again must not share storage
+    small = state;
+    REQUIRE(small == state);
+    small.doAction(ActionType("Probe"));
+    REQUIRE(small != state);
+    REQUIRE(copy == state);
+}
+
+TEST_CASE("Undoing journaled actions restores the previous state")
+{
+    for (GameState state : { MakeProtossStartState(), MakeTerranStartState(), MakeZergStartState() })
+    {
+        std::vector<ActionType> legalActions;
+        for (size_t step = 0; step < 40; ++step)
+        {
+            state.getLegalActions(legalActions);
+            REQUIRE(!legalActions.empty());
+
+            // undo every legal action, done twice in a row so that one journal covers several actions
+            for (const ActionType & action : legalActions)
+            {
+                const GameState before = state;
+                UndoJournal journal;
+                state.doAction(action, journal);
+                if (state.isLegal(action)) { state.doAction(action, journal); }
+                state.undoAction(journal);
+
+                REQUIRE(state == before);
+                for (const ActionType & type : ActionTypes::GetAllActionTypes())
+                {
+                    REQUIRE(state.getNumTotal(type) == before.getNumTotal(type));
+                    REQUIRE(state.getNumCompleted(type) == before.getNumCompleted(type));
+                    REQUIRE(state.getNumInProgress(type) == before.getNumInProgress(type));
+                }
+            }
+
+            // then move on down a deterministic but varied path
+            state.doAction(legalActions[(step * 7) % legalActions.size()]);
+        }
+    }
+}
+
+TEST_CASE("GameState hash")
+{
+    GameState state = MakeZergStartState();
+    REQUIRE(state.hash() == GameState(state).hash());
+
+    std::vector<std::string> buildOrder = { "Drone", "Drone", "Overlord", "SpawningPool", "Drone", "Extractor", "Zergling", "Hatchery", "Zergling" };
+    for (const std::string & name : buildOrder)
+    {
+        const ActionType type(name);
+
+        // fast forwarding in small steps must give the same hash as one big step
+        GameState slowState = state;
+        const int ready = state.whenCanBuild(type);
+        for (int f = slowState.getCurrentFrame() + 1; f <= ready; f += 7) { slowState.fastForward(f); }
+        slowState.fastForward(ready);
+        state.fastForward(ready);
+        REQUIRE(slowState.hash() == state.hash());
+
+        // undoing an action must restore the hash
+        const uint64_t before = state.hash();
+        UndoJournal journal;
+        state.doAction(type, journal);
+        REQUIRE(state.hash() != before);
+        GameState undone = state;
+        undone.undoAction(journal);
+        REQUIRE(undone.hash() == before);
+    }
+
+    // the same units reached in a different order at the same time hash the same
+    GameState a = MakeProtossStartState();
+    GameState b = MakeProtossStartState();
+    a.addUnit(ActionType("Pylon"));
+    a.addUnit(ActionType("Gateway"));
+    b.addUnit(ActionType("Gateway"));
+    b.addUnit(ActionType("Pylon"));
+    REQUIRE(a.hash() == b.hash());
+    a.addUnit(ActionType("Zealot"));
+    REQUIRE(a.hash() != b.hash());
+
+    // the same units, resources and frame, but the new hatchery's larva timer started at a different time
+    GameState early = MakeZergStartState();
+    early.setMinerals(400);
+    for (const char * name : { "Hatchery", "Drone", "SpawningPool" }) { early.doAction(ActionType(name)); }
+    early.fastForward(early.getCurrentFrame() + 50);
+    early.doAction(ActionType("SpawningPool"));
+
+    GameState late = MakeZergStartState();
+    late.setMinerals(400);
+    late.fastForward(late.getCurrentFrame() + 150);
+    for (const char * name : { "Drone", "Hatchery", "SpawningPool" }) { late.doAction(ActionType(name)); }
+    late.fastForward(late.getCurrentFrame() + 100);
+    late.doAction(ActionType("SpawningPool"));
+
+    REQUIRE(early.getCurrentFrame() == late.getCurrentFrame());
+    REQUIRE(early.getMinerals() == late.getMinerals());
+    REQUIRE(early.getNumTotal(ActionType("Larva")) == late.getNumTotal(ActionType("Larva")));
+    REQUIRE(early.hash() != late.hash());
+}
+
+TEST_CASE("TranspositionTable stores and replaces entries")
+{
+    TranspositionTable table(1000);
+    REQUIRE(table.size() == 1024);
+
+    int finishTime = -1;
+    REQUIRE_FALSE(table.lookup(12345, finishTime));
+
+    table.store(12345, 0);
+    REQUIRE(table.lookup(12345, finishTime));
+    REQUIRE(finishTime == 0);
+
+    // a different key in the same slot replaces the old one
+    table.store(12345 + 1024, 500);
+    REQUIRE_FALSE(table.lookup(12345, finishTime));
+    REQUIRE(table.lookup(12345 + 1024, finishTime));
+    REQUIRE(finishTime == 500);
+
+    table.clear();
+    REQUIRE_FALSE(table.lookup(12345 + 1024, finishTime));
+}
+
+TEST_CASE("Parallel DFBB finds the same makespan as the serial search")
+{
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 2);
+
+    DFBB_BuildOrderSmartSearch serial;
+    serial.setState(MakeProtossStartState());
+    serial.setGoal(goal);
+    serial.setTimeLimit(0);
+    serial.search();
+
+    DFBB_BuildOrderSmartSearch parallel;
+    parallel.setState(MakeProtossStartState());
+    parallel.setGoal(goal);
+    parallel.setTimeLimit(0);
+    parallel.setNumThreads(4);
+    parallel.search();
+
+    REQUIRE(serial.getResults().solved);
+    REQUIRE(parallel.getResults().solved);
+    REQUIRE(parallel.getResults().upperBound == serial.getResults().upperBound);
+    REQUIRE(Tools::GetBuildOrderCompletionTime(MakeProtossStartState(), parallel.getResults().buildOrder) == parallel.getResults().upperBound);
+}
+
+TEST_CASE("Parallel DFBB resumes after a timeout and finds the serial makespan")
+{
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 3);
+    goal.setGoal(ActionType("Zealot"), 2);
+
+    DFBB_BuildOrderSmartSearch serial;
+    serial.setState(MakeProtossStartState());
+    serial.setGoal(goal);
+    serial.setTimeLimit(0);
+    serial.search();
+    REQUIRE(serial.getResults().solved);
+
+    // the stored states in the transposition table must not prune the tasks left over from an earlier call
+    for (const bool useTranspositionTable : { true, false })
+    {
+        DFBB_BuildOrderSmartSearch parallel;
+        parallel.setState(MakeProtossStartState());
+        parallel.setGoal(goal);
+        parallel.setTimeLimit(20);
+        parallel.setNumThreads(4);
+        parallel.setUseTranspositionTable(useTranspositionTable);
+
+        size_t calls = 0;
+        do
+        {
+            parallel.search();
+            ++calls;
+        }
+        while (!parallel.getResults().solved && calls < 10000);
+
+        REQUIRE(calls > 1);
+        REQUIRE(parallel.getResults().solved);
+        REQUIRE(parallel.getResults().upperBound == serial.getResults().upperBound);
+        REQUIRE(Tools::GetBuildOrderCompletionTime(MakeProtossStartState(), parallel.getResults().buildOrder) == parallel.getResults().upperBound);
+    }
+}
+
+TEST_CASE("Deadline expires at its time limit and when cancelled")
+{
+    Deadline deadline;
+    REQUIRE(!deadline.expired());
+
+    // no time limit never expires on its own
+    deadline.start(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    REQUIRE(!deadline.expired());
+    deadline.cancel();
+    REQUIRE(deadline.expired());
+
+    // starting again clears the flag
+    deadline.start(10);
+    REQUIRE(!deadline.expired());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(deadline.expired());
+
+    // stopping the timer early leaves the flag clear
+    deadline.start(60000);
+    deadline.stop();
+    REQUIRE(!deadline.expired());
+}
+
+TEST_CASE("A* replaying node states finds the same solution as storing them")
+{
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 2);
+
+    DFBB_BuildOrderSearchResults results[2];
+    for (size_t i(0); i < 2; ++i)
+    {
+        AStarBuildOrderSearch search;
+        search.setState(MakeProtossStartState());
+        search.setGoal(goal);
+        search.setTimeLimit(0);
+        search.setStoreNodeStates(i == 0);
+        search.search();
+        results[i] = search.getResults();
+    }
+
+    REQUIRE(results[0].solved);
+    REQUIRE(results[1].solved);
+    REQUIRE(results[0].upperBound == results[1].upperBound);
+    REQUIRE(results[0].nodesExpanded == results[1].nodesExpanded);
+    REQUIRE(results[0].buildOrder.getNameString() == results[1].buildOrder.getNameString());
+    REQUIRE(Tools::GetBuildOrderCompletionTime(MakeProtossStartState(), results[1].buildOrder) == results[1].upperBound);
+}
+
+TEST_CASE("Memory bounded A* falls back to IDA* and finds the same makespan")
+{
+    const GameState initialState = MakeZergStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Zergling"), 9);
+
+    AStarBuildOrderSearch unbounded;
+    unbounded.setState(initialState);
+    unbounded.setGoal(goal);
+    unbounded.setTimeLimit(0);
+    unbounded.search();
+
+    AStarBuildOrderSearch bounded;
+    bounded.setState(initialState);
+    bounded.setGoal(goal);
+    bounded.setTimeLimit(0);
+    bounded.setMemoryLimitMB(1);
+    bounded.search();
+
+    REQUIRE(unbounded.getResults().solved);
+    REQUIRE(bounded.getResults().solved);
+    REQUIRE(bounded.getResults().upperBound == unbounded.getResults().upperBound);
+    REQUIRE(bounded.getResults().nodesExpanded > unbounded.getResults().nodesExpanded);
+    REQUIRE(Tools::GetBuildOrderCompletionTime(initialState, bounded.getResults().buildOrder) == bounded.getResults().upperBound);
+}
+
+TEST_CASE("Hash distributed A* finds the same makespan as the serial search")
+{
+    const GameState initialState = MakeProtossStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 3);
+
+    AStarBuildOrderSearch serial;
+    serial.setState(initialState);
+    serial.setGoal(goal);
+    serial.setTimeLimit(0);
+    serial.search();
+
+    for (const bool storeNodeStates : { true, false })
+    {
+        AStarBuildOrderSearch parallel;
+        parallel.setState(initialState);
+        parallel.setGoal(goal);
+        parallel.setTimeLimit(0);
+        parallel.setNumThreads(4);
+        parallel.setStoreNodeStates(storeNodeStates);
+        parallel.search();
+
+        REQUIRE(parallel.getResults().solved);
+        REQUIRE(parallel.getResults().upperBound == serial.getResults().upperBound);
+        REQUIRE(Tools::GetBuildOrderCompletionTime(initialState, parallel.getResults().buildOrder) == parallel.getResults().upperBound);
+    }
+}
+
+TEST_CASE("BucketQueue pops the lowest priority first, in FIFO order within a priority")
+{
+    struct Entry { int priority; int id; };
+
+    BucketQueue<Entry> queue;
+    queue.push(Entry{ 5, 0 });
+    queue.push(Entry{ 3, 1 });
+    queue.push(Entry{ 5, 2 });
+    queue.push(Entry{ 3, 3 });
+    REQUIRE(queue.size() == 4);
+
+    REQUIRE(queue.top().id == 1); queue.pop();
+    REQUIRE(queue.top().id == 3); queue.pop();
+
+    // a lower priority pushed later still comes out first
+    queue.push(Entry{ 1, 4 });
+    REQUIRE(queue.top().id == 4); queue.pop();
+    REQUIRE(queue.top().id == 0); queue.pop();
+    REQUIRE(queue.top().id == 2); queue.pop();
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("NodeArena keeps indices and references valid as it grows")
+{
+    NodeArena<int, 2> arena;
+    REQUIRE(arena.add(10) == 0);
+    const int * first = &arena[0];
+
+    // grows over several chunks of 4
+    for (int i(1); i < 10; ++i)
+    {
+        REQUIRE(arena.add(10 + i) == static_cast<size_t>(i));
+    }
+
+    REQUIRE(arena.size() == 10);
+    REQUIRE(first == &arena[0]);
+    REQUIRE(arena[9] == 19);
+
+    const NodeArena<int, 2> copy(arena);
+    REQUIRE(copy.size() == 10);
+    REQUIRE(copy[5] == 15);
+
+    arena.clear();
+    REQUIRE(arena.size() == 0);
+    REQUIRE(arena.add(7) == 0);
+    REQUIRE(arena[0] == 7);
+}
+
+TEST_CASE("A* with the bucket open list finds the same makespan as with the heap")
+{
+    const GameState initialState = MakeProtossStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 3);
+
+    DFBB_BuildOrderSearchResults results[2];
+    for (size_t i(0); i < 2; ++i)
+    {
+        AStarBuildOrderSearch search;
+        search.setState(initialState);
+        search.setGoal(goal);
+        search.setTimeLimit(0);
+        search.setUseBucketQueue(i == 1);
+        search.search();
+        results[i] = search.getResults();
+    }
+
+    REQUIRE(results[0].solved);
+    REQUIRE(results[1].solved);
+    REQUIRE(results[1].upperBound == results[0].upperBound);
+    REQUIRE(Tools::GetBuildOrderCompletionTime(initialState, results[1].buildOrder) == results[1].upperBound);
+}
+
+TEST_CASE("Root and tree parallel MCTS find valid build orders")
+{
+    const GameState initialState = MakeProtossStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 2);
+
+    for (const bool useTreeParallelism : { false, true })
+    {
+        MonteCarloTreeSearch search;
+        search.setState(initialState);
+        search.setGoal(goal);
+        search.setTimeLimit(0);
+        search.setIterationLimit(200);
+        search.setNumThreads(4);
+        search.setUseTreeParallelism(useTreeParallelism);
+        search.search();
+
+        const DFBB_BuildOrderSearchResults & results = search.getResults();
+        REQUIRE(results.solutionFound);
+        REQUIRE(results.nodesExpanded <= 200);
+        REQUIRE(Tools::GetBuildOrderCompletionTime(initialState, results.buildOrder) == results.upperBound);
+    }
+}
+
+TEST_CASE("Every MCTS rollout policy finds a valid build order")
+{
+    const GameState initialState = MakeProtossStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 2);
+
+    for (const RolloutPolicyType policy : { RolloutPolicyType::Naive, RolloutPolicyType::RandomPlayout, RolloutPolicyType::Heuristic })
+    {
+        MonteCarloTreeSearch search;
+        search.setState(initialState);
+        search.setGoal(goal);
+        search.setTimeLimit(0);
+        search.setIterationLimit(2000);
+        search.setRolloutPolicy(policy);
+        search.search();
+
+        const DFBB_BuildOrderSearchResults & results = search.getResults();
+        INFO(RolloutPolicy::GetPolicyName(policy));
+        REQUIRE(results.solutionFound);
+        REQUIRE(Tools::GetBuildOrderCompletionTime(initialState, results.buildOrder) == results.upperBound);
+    }
+}
+
+TEST_CASE("MCTS with transpositions finds valid build orders")
+{
+    const GameState initialState = MakeProtossStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Zealot"), 4);
+
+    for (const size_t threads : { 1, 4 })
+    {
+        MonteCarloTreeSearch search;
+        search.setState(initialState);
+        search.setGoal(goal);
+        search.setTimeLimit(0);
+        search.setIterationLimit(2000);
+        search.setNumThreads(threads);
+        search.setUseTreeParallelism(true);
+        search.setUseTranspositions(true);
+        search.search();
+
+        const DFBB_BuildOrderSearchResults & results = search.getResults();
+        REQUIRE(results.solutionFound);
+        REQUIRE(Tools::GetBuildOrderCompletionTime(initialState, results.buildOrder) == results.upperBound);
+    }
+}
+
+TEST_CASE("Prerequisites follow units being built, completed and undone")
+{
+    GameState state = MakeProtossStartState();
+    const ActionType probe("Probe"), pylon("Pylon"), gateway("Gateway"), core("CyberneticsCore");
+
+    for (const ActionType & type : { probe, probe, probe, probe, pylon })
+    {
+        state.doAction(type);
+    }
+
+    REQUIRE(!state.isLegal(core));
+
+    // a gateway in progress is enough for the core to be legal, but it can't start until the gateway finishes
+    UndoJournal journal;
+    state.doAction(gateway, journal);
+    REQUIRE(state.isLegal(core));
+    REQUIRE(state.whenCanBuild(core) >= state.getCurrentFrame() + gateway.buildTime());
+
+    GameState undone = state;
+    undone.undoAction(journal);
+    REQUIRE(!undone.isLegal(core));
+
+    // and once it has finished the core only waits on resources
+    state.fastForward(state.getCurrentFrame() + gateway.buildTime());
+    state.setMinerals(1000);
+    REQUIRE(state.whenCanBuild(core) == state.getCurrentFrame());
+}
+
+TEST_CASE("LowerBoundEvaluator matches Tools lower bound along a build order")
+{
+    const std::vector<std::pair<GameState, std::vector<std::string>>> cases =
+    {
+        { MakeProtossStartState(), { "DarkTemplar", "DarkTemplar", "Dragoon" } },
+        { MakeTerranStartState(),  { "Battlecruiser", "Marine" } },
+        { MakeZergStartState(),    { "Mutalisk", "Mutalisk", "Zergling" } }
+    };
+
+    for (const auto & c : cases)
+    {
+        BuildOrderSearchGoal goal;
+        for (const std::string & name : c.second)
+        {
+            goal.setGoal(ActionType(name), goal.getGoal(ActionType(name)) + 1);
+        }
+
+        const LowerBoundEvaluator evaluator(goal);
+        GameState state = c.first;
+        REQUIRE(evaluator.getLandmarkLowerBound(state) == Tools::GetLowerBound(state, goal));
+        REQUIRE(evaluator.getLandmarkLowerBound(state) > 0);
+
+        // check every state along a solution, both when each action is started and halfway through its build
+        NaiveBuildOrderSearch naiveSearch(state, goal);
+        const BuildOrder buildOrder = naiveSearch.solve();
+        for (size_t a(0); a < buildOrder.size(); ++a)
+        {
+            state.doAction(buildOrder[a]);
+            REQUIRE(evaluator.getLandmarkLowerBound(state) == Tools::GetLowerBound(state, goal));
+
+            GameState later = state;
+            later.fastForward(state.getCurrentFrame() + buildOrder[a].buildTime() / 2);
+            REQUIRE(evaluator.getLandmarkLowerBound(later) == Tools::GetLowerBound(later, goal));
+        }
+
+        state.fastForward(state.getLastActionFinishTime());
+        REQUIRE(evaluator.getLandmarkLowerBound(state) == 0);
+    }
+}
+
+TEST_CASE("Resource lower bound never exceeds the optimal makespan")
+{
+    const std::vector<std::pair<GameState, std::pair<std::string, size_t>>> cases =
+    {
+        { MakeProtossStartState(), { "Dragoon", 2 } },
+        { MakeTerranStartState(),  { "Vulture", 2 } },
+        { MakeZergStartState(),    { "Zergling", 8 } }
+    };
+
+    for (const auto & c : cases)
+    {
+        const GameState & initialState = c.first;
+        BuildOrderSearchGoal goal;
+        goal.setGoal(ActionType(c.second.first), c.second.second);
+
+        DFBB_BuildOrderSmartSearch landmarkOnly;
+        landmarkOnly.setState(initialState);
+        landmarkOnly.setGoal(goal);
+        landmarkOnly.setTimeLimit(0);
+        landmarkOnly.setUseResourceLowerBound(false);
+        landmarkOnly.search();
+
+        DFBB_BuildOrderSmartSearch both;
+        both.setState(initialState);
+        both.setGoal(goal);
+        both.setTimeLimit(0);
+        both.search();
+
+        REQUIRE(landmarkOnly.getResults().solved);
+        REQUIRE(both.getResults().solved);
+        REQUIRE(both.getResults().upperBound == landmarkOnly.getResults().upperBound);
+        REQUIRE(both.getResults().nodesExpanded <= landmarkOnly.getResults().nodesExpanded);
+
+        // the search lets workers be made, so the bound must allow for them too
+        const ActionType worker = ActionTypes::GetWorker(initialState.getRace());
+        goal.setGoalMax(worker, 100);
+        const LowerBoundEvaluator evaluator(goal, false, true);
+        const BuildOrder & buildOrder = both.getResults().buildOrder;
+        const int makespan = both.getResults().upperBound;
+
+        GameState state = initialState;
+        REQUIRE(evaluator.getResourceLowerBound(state) > 0);
+        for (size_t a(0); a < buildOrder.size(); ++a)
+        {
+            REQUIRE(state.getCurrentFrame() + evaluator.getResourceLowerBound(state) <= makespan);
+            state.doAction(buildOrder[a]);
+        }
+    }
+}
+
+TEST_CASE("Builder lower bound queues the goal on the buildings that make it")
+{
+    GameState state = MakeProtossStartState();
+    state.addUnit(ActionType("Pylon"));
+    state.addUnit(ActionType("Gateway"));
+
+    const ActionType zealot("Zealot");
+    BuildOrderSearchGoal goal;
+    goal.setGoal(zealot, 6);
+
+    // one gateway has to make all six, but a second one halves the rest of the queue once it's built
+    REQUIRE(LowerBoundEvaluator(goal, false, false, true).getBuilderLowerBound(state) == 6 * zealot.buildTime());
+
+    goal.setGoalMax(ActionType("Gateway"), 2);
+    const int withSecondGateway = LowerBoundEvaluator(goal, false, false, true).getBuilderLowerBound(state);
+    REQUIRE(withSecondGateway < 6 * zealot.buildTime());
+    REQUIRE(withSecondGateway >= 3 * zealot.buildTime());
+
+    // the optimal makespan is the same with every bound turned on
+    for (const auto & c : std::vector<std::pair<GameState, std::pair<std::string, size_t>>> {
+            { MakeProtossStartState(), { "Zealot", 6 } },
+            { MakeTerranStartState(),  { "Marine", 6 } } })
+    {
+        BuildOrderSearchGoal searchGoal;
+        searchGoal.setGoal(ActionType(c.second.first), c.second.second);
+
+        DFBB_BuildOrderSmartSearch landmarkOnly;
+        landmarkOnly.setState(c.first);
+        landmarkOnly.setGoal(searchGoal);
+        landmarkOnly.setTimeLimit(0);
+        landmarkOnly.setUseResourceLowerBound(false);
+        landmarkOnly.setUseBuilderLowerBound(false);
+        landmarkOnly.search();
+
+        DFBB_BuildOrderSmartSearch all;
+        all.setState(c.first);
+        all.setGoal(searchGoal);
+        all.setTimeLimit(0);
+        all.search();
+
+        REQUIRE(landmarkOnly.getResults().solved);
+        REQUIRE(all.getResults().solved);
+        REQUIRE(all.getResults().upperBound == landmarkOnly.getResults().upperBound);
+        REQUIRE(all.getResults().nodesExpanded <= landmarkOnly.getResults().nodesExpanded);
+    }
+}
+
+TEST_CASE("Heuristic tables bound a goal by its projection onto the key types")
+{
+    const GameState state = MakeProtossStartState();
+    const ActionType assimilator("Assimilator");
+    const ActionType gateway("Gateway");
+    const ActionType core("CyberneticsCore");
+    const std::string filename = "heuristic_table_test.bin";
+
+    HeuristicTables::Clear();
+    const HeuristicTable table = HeuristicTables::Build(state, { { assimilator, 1 }, { gateway, 2 }, { core, 1 } }, 0);
+    HeuristicTables::Add(table);
+    HeuristicTables::Save(filename);
+    HeuristicTables::Clear();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Dragoon"), 2);
+    goal.setGoal(gateway, 2);
+    REQUIRE(HeuristicTables::GetLowerBound(state, goal) == 0);
+
+    HeuristicTables::Load(filename);
+    std::remove(filename.c_str());
+
+    // every entry is an optimal makespan, so the smart search's abstractions can only match or lose to it
+    for (size_t i(1); i < table.size(); ++i)
+    {
+        DFBB_BuildOrderSmartSearch smartSearch;
+        smartSearch.setState(state);
+        smartSearch.setGoal(table.getGoal(i));
+        smartSearch.setTimeLimit(0);
+        smartSearch.search();
+
+        const int smartMakespan = smartSearch.getResults().solutionFound ? smartSearch.getResults().upperBound : Tools::GetUpperBound(state, table.getGoal(i));
+        REQUIRE(HeuristicTables::GetLowerBound(state, table.getGoal(i)) == table.getMakespan(i));
+        REQUIRE(table.getMakespan(i) <= smartMakespan);
+    }
+
+    // the smart search always makes workers first, which this build order doesn't, and the table must not be later than it
+    BuildOrderSearchGoal gasAndGateway;
+    gasAndGateway.setGoal(assimilator, 1);
+    gasAndGateway.setGoal(gateway, 1);
+
+    BuildOrder gasAndGatewayBuildOrder;
+    for (const char * name : { "Probe", "Pylon", "Gateway", "Assimilator" })
+    {
+        gasAndGatewayBuildOrder.add(ActionType(name));
+    }
+    GameState gasAndGatewayState = state;
+    Tools::DoBuildOrder(gasAndGatewayState, gasAndGatewayBuildOrder);
+    REQUIRE(gasAndGateway.isAchievedBy(gasAndGatewayState));
+    REQUIRE(HeuristicTables::GetLowerBound(state, gasAndGateway) <= Tools::GetBuildOrderCompletionTime(state, gasAndGatewayBuildOrder));
+
+    // dragoons need a cybernetics core, so the goal's bound is the optimal makespan for it and the two gateways
+    BuildOrderSearchGoal projected;
+    projected.setGoal(gateway, 2);
+    projected.setGoal(core, 1);
+
+    const int tableFinishFrame = HeuristicTables::GetLowerBound(state, goal);
+    REQUIRE(tableFinishFrame > 0);
+    REQUIRE(HeuristicTables::GetLowerBound(state, projected) == tableFinishFrame);
+    REQUIRE(Tools::GetLowerBound(state, goal) >= tableFinishFrame - state.getCurrentFrame());
+
+    // the table is keyed by type names, so the same state with its units made in another order finds it too
+    GameState reordered;
+    for (const char * name : { "Probe", "Probe", "Nexus", "Probe", "Probe" })
+    {
+        reordered.addUnit(ActionType(name));
+    }
+    reordered.setMinerals(50);
+    REQUIRE(reordered.getNameKey() == state.getNameKey());
+    REQUIRE(HeuristicTables::GetLowerBound(reordered, goal) == tableFinishFrame);
+
+    // states the table wasn't built from have no bound
+    GameState later = state;
+    later.doAction(ActionType("Probe"));
+    REQUIRE(HeuristicTables::GetLowerBound(later, goal) == 0);
+
+    // the table only raises the bound, so the search still finds the same makespan
+    DFBB_BuildOrderSmartSearch withTable;
+    withTable.setState(state);
+    withTable.setGoal(goal);
+    withTable.setTimeLimit(0);
+    withTable.search();
+
+    HeuristicTables::Clear();
+
+    DFBB_BuildOrderSmartSearch withoutTable;
+    withoutTable.setState(state);
+    withoutTable.setGoal(goal);
+    withoutTable.setTimeLimit(0);
+    withoutTable.search();
+
+    REQUIRE(withTable.getResults().solved);
+    REQUIRE(withoutTable.getResults().solved);
+    REQUIRE(tableFinishFrame <= withoutTable.getResults().upperBound);
+    REQUIRE(withTable.getResults().upperBound == withoutTable.getResults().upperBound);
+    REQUIRE(withTable.getResults().nodesExpanded <= withoutTable.getResults().nodesExpanded);
+}
+
+TEST_CASE("Build order server rejects requests it can't search")
+{
+    EnsureInit();
+    const BuildOrderServer server(1, 1000, 5000);
+
+    const json valid = json::parse(R"({ "id" : 3, "state" : { "minerals" : 50, "units" : [ ["Probe", 4], ["Nexus", 1] ] }, "goal" : { "goal" : [ ["Zealot", 1] ] } })");
+    REQUIRE(server.validateRequest(valid) == "");
+
+    auto withState = [&](const std::string & units, const std::string & goal = R"([ ["Zealot", 1] ])")
+    {
+        json request = valid;
+        request["state"]["units"] = json::parse(units);
+        request["goal"]["goal"] = json::parse(goal);
+        return server.validateRequest(request);
+    };
+
+    REQUIRE(withState(R"([ ["Probe", 4], ["Nexus", 1], ["Drone", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Probe", 4], ["Pylon", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Probe", 4], ["Nexus", 1], ["Gateway", 1] ])") == "");
+    REQUIRE(withState(R"([ ["Probe", 4], ["Nexus", 1], ["Foo", 1] ])") != "");
+
+    // the supply units use has to fit in what the state provides and under the 200 cap
+    REQUIRE(withState(R"([ ["Probe", 200], ["Nexus", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Probe", 200], ["Nexus", 1], ["Pylon", 30] ])") == "");
+    REQUIRE(withState(R"([ ["Probe", 200], ["Nexus", 1], ["Pylon", 30], ["Zealot", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Probe", 9], ["Nexus", 1] ])") == "");
+    REQUIRE(withState(R"([ ["Probe", 10], ["Nexus", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Drone", 4], ["Hatchery", 1] ])", R"([ ["Zergling", 2] ])") != "");
+    REQUIRE(withState(R"([ ["Drone", 4], ["Hatchery", 1], ["Overlord", 1] ])", R"([ ["Zergling", 2] ])") == "");
+
+    // the naive build order every search falls back on can't morph units from other units
+    REQUIRE(withState(R"([ ["Probe", 4], ["Nexus", 1] ])", R"([ ["Archon", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Drone", 4], ["Hatchery", 1], ["Overlord", 1] ])", R"([ ["Lurker", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Drone", 4], ["Hatchery", 1], ["Overlord", 1] ])", R"([ ["Guardian", 1] ])") != "");
+    REQUIRE(withState(R"([ ["Drone", 4], ["Hatchery", 1], ["Overlord", 1] ])", R"([ ["Lair", 1], ["Spire", 1], ["Mutalisk", 1] ])") == "");
+
+    json request = valid;
+    request["goal"]["goal"] = json::parse(R"([ ["Zealot", 0] ])");
+    REQUIRE(server.validateRequest(request) != "");
+
+    request = valid;
+    request["search"] = "BFS";
+    REQUIRE(server.validateRequest(request) != "");
+
+    request = valid;
+    request["timeLimitMS"] = 0;
+    REQUIRE(server.validateRequest(request) != "");
+
+    // a rejected request still comes back with its id
+    request = valid;
+    request["state"]["units"] = json::parse(R"([ ["Probe", 200], ["Nexus", 1] ])");
+    const json result = json::parse(server.handleRequest(request.dump()));
+    REQUIRE(result["id"] == 3);
+    REQUIRE(result.count("error"));
+    REQUIRE_FALSE(result.count("buildOrder"));
+
+    REQUIRE(json::parse(server.handleRequest("{ not json")).count("error"));
+}
+
+TEST_CASE("Build order server answers with a build order that reaches the goal")
+{
+    EnsureInit();
+    const BuildOrderServer server(1, 1000, 5000);
+    const GameState state = MakeProtossStartState();
+
+    BuildOrderSearchGoal goal;
+    goal.setGoal(ActionType("Zealot"), 2);
+
+    for (const char * search : { "DFBB", "AStar", "MCTS", "Naive" })
+    {
+        json request = json::parse(R"({ "id" : "a", "state" : { "minerals" : 50, "units" : [ ["Nexus", 1], ["Probe", 4] ] }, "goal" : { "goal" : [ ["Zealot", 2] ] }, "timeLimitMS" : 500 })");
+        request["search"] = search;
+
+        const json result = json::parse(server.handleRequest(request.dump()));
+        REQUIRE_FALSE(result.count("error"));
+        REQUIRE(result["id"] == "a");
+        REQUIRE(result["search"] == search);
+
+        BuildOrder buildOrder;
+        for (const auto & name : result["buildOrder"])
+        {
+            buildOrder.add(ActionType(name.get<std::string>()));
+        }
+
+        GameState finalState = state;
+        Tools::DoBuildOrder(finalState, buildOrder);
+        REQUIRE(goal.isAchievedBy(finalState));
+        REQUIRE(result["makespan"] == Tools::GetBuildOrderCompletionTime(state, buildOrder));
+    }
+}